@@ -51,7 +51,7 @@ void example() {
   }
   for (int i=0; i <255 ; i++) {
   level = (255-i) ;
-  pixels.setBrightnessFunctions(adjust,adjust,adjust,adjust);
+  pixels.updateBrightnessFunctions(); // re-evaluate adjust() at the new level
   pixels.show() ;
   sleep_ms(CYCLEDELAY);
   }
@@ -0,0 +1,820 @@
+/*!
+ * @file NeoPixelHost.cpp
+ *
+ * Stub Pico SDK for the host build. Nothing runs in real time: the clock
+ * is a counter that sleeps and waits move forward. A word put into a TX
+ * FIFO gets its times fixed on the spot from the FIFO depth and the state
+ * machine's bit time, so FIFO levels, DMA completion and the waveform on
+ * each pin follow from the same model. DMA channels raise IRQ 0 when the
+ * clock passes the time their last word entered the FIFO.
+ *
+ */
+
+#include "NeoPixelHost.hpp"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/sync.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include <atomic>
+#include <cmath>
+#include <cstdarg>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#define HOST_FIFO_DEPTH 8       // both programs join the FIFOs
+#define HOST_NS_PER_CYCLE 8     // 125 MHz system clock
+#define HOST_NEVER UINT64_MAX
+
+pio_hw_t neopixel_host_pio_hw[NUM_PIOS];
+
+namespace {
+
+struct FifoWord {
+  uint64_t enter;  // written into the FIFO
+  uint64_t start;  // pulled into the shift register
+};
+
+struct StateMachine {
+  bool                 claimed;
+  pio_sm_config        config;
+  std::deque<FifoWord> fifo;      // words not pulled yet, oldest first
+  uint64_t             busyUntil; // end of the last word shifted out
+};
+
+struct Lane {
+  NeoPixelHostPin   pin;
+  bool              open;         // frame being received
+  NeoPixelHostFrame frame;
+  uint64_t          lastEnd;      // end of the last latched frame
+  uint8_t           bits, acc;    // partial byte
+};
+
+struct Channel {
+  bool               claimed;
+  dma_channel_config config;
+  int                pio, sm;     // target TX FIFO, -1 if elsewhere
+  bool               active;      // transfer not finished
+  uint64_t           doneAt;
+  bool               irqEnabled, irqRaw;
+};
+
+std::mutex                 model;   // everything below but the clock
+std::atomic<uint64_t>      clockNs(0);
+StateMachine               sms[NUM_PIOS][NUM_PIO_STATE_MACHINES];
+uint32_t                   programSlots[NUM_PIOS];
+Channel                    channels[NUM_DMA_CHANNELS];
+std::map<uint, Lane>       lanes;
+std::map<uint, std::vector<irq_handler_t> > handlers;
+std::map<uint, bool>       nvicEnabled[NUM_CORES]; // each core has its own NVIC
+std::atomic<uint32_t>      writes(0), allocs(0);
+std::atomic<uint32_t>      failing(0);  // allocations still to fail
+spin_lock_t                spinLocks[32];
+uint32_t                   spinLocksClaimed = 0;
+std::atomic<uint>          nextStriped(0);
+std::thread                core1;
+std::atomic<bool>          core1Running(false);
+
+thread_local bool          masked = false;     // interrupts disabled
+thread_local bool          inHandler = false;
+thread_local uint          coreNum = 0;
+thread_local uint          modelDepth = 0;     // inside the model's lock
+
+// Holds the model's lock. Allocations the model makes for itself while
+// holding it aren't the code under test's, so they aren't counted.
+struct ModelGuard {
+  std::lock_guard<std::mutex> lock;
+  ModelGuard() : lock(model) { modelDepth++; }
+  ~ModelGuard() { modelDepth--; }
+};
+
+[[noreturn]] void panic(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fputc('\n', stderr);
+  abort();
+}
+
+uint64_t bitNs(const pio_sm_config &c) {
+  return (uint64_t)llround((double)c.clkdiv * c.bit_cycles * HOST_NS_PER_CYCLE);
+}
+
+bool isParallel(const pio_sm_config &c) {
+  return c.out_count != 0 && c.sideset_count == 0;
+}
+
+// bit times per FIFO word: one per bit, or one per 8 bit plane
+uint wordBits(const pio_sm_config &c) {
+  return isParallel(c) ? c.pull_threshold / 8 : c.pull_threshold;
+}
+
+void latch(Lane &l) {
+  NeoPixelHostFrame &f = l.frame;
+  if (l.pin.leds.size() < f.bytes.size()) l.pin.leds.resize(f.bytes.size());
+  std::copy(f.bytes.begin(), f.bytes.end(), l.pin.leds.begin());
+  l.lastEnd = f.endNs;
+  l.pin.frames.push_back(f);
+  l.open = false;
+  l.bits = l.acc = 0;
+}
+
+void pushBit(uint gpio, bool bit, uint64_t t, uint64_t ns) {
+  Lane &l = lanes[gpio];
+  if (l.open && t >= l.frame.endNs + NEOPIXEL_HOST_FRAME_GAP_US * 1000ull) latch(l);
+  if (!l.open) {
+    l.open = true;
+    l.frame = NeoPixelHostFrame();
+    l.frame.startNs = t;
+    l.frame.gapNs = l.pin.frames.empty() ? HOST_NEVER : t - l.lastEnd;
+    l.frame.stallNs = 0;
+  } else if (t > l.frame.endNs && t - l.frame.endNs > l.frame.stallNs) {
+    l.frame.stallNs = t - l.frame.endNs;
+  }
+  l.acc = (uint8_t)((l.acc << 1) | bit);
+  if (++l.bits == 8) {
+    l.frame.bytes.push_back(l.acc);
+    l.bits = l.acc = 0;
+  }
+  l.frame.endNs = t + ns;
+}
+
+void decode(const pio_sm_config &c, uint32_t data, uint64_t start) {
+  uint64_t ns = bitNs(c);
+  if (isParallel(c)) {
+    for (uint p = 0 ; p < wordBits(c) ; p++) {
+      uint8_t plane = c.shift_right ? (data >> (8 * p)) : (data >> (24 - 8 * p));
+      for (uint n = 0 ; n < c.out_count ; n++) pushBit(c.out_base + n, (plane >> n) & 1, start + p * ns, ns);
+    }
+  } else {
+    for (uint k = 0 ; k < c.pull_threshold ; k++) {
+      bool bit = c.shift_right ? (data >> k) & 1 : (data >> (31 - k)) & 1;
+      pushBit(c.sideset_base, bit, start + k * ns, ns);
+    }
+  }
+}
+
+// drop the words the state machine has pulled by now
+void prune(StateMachine &s) {
+  uint64_t now = clockNs;
+  while (!s.fifo.empty() && s.fifo.front().start <= now) s.fifo.pop_front();
+}
+
+uint level(StateMachine &s) {
+  prune(s);
+  uint64_t now = clockNs;
+  uint n = 0;
+  for (const FifoWord &w : s.fifo) if (w.enter <= now) n++;
+  return n;
+}
+
+// Put a word into the FIFO no earlier than notBefore, waiting for room.
+// Returns when it went in.
+uint64_t enqueue(StateMachine &s, uint32_t data, uint64_t notBefore) {
+  prune(s);
+  uint64_t enter = notBefore;
+  if (!s.fifo.empty() && s.fifo.back().enter > enter) enter = s.fifo.back().enter;
+  if (s.fifo.size() >= HOST_FIFO_DEPTH) {
+    uint64_t room = s.fifo[s.fifo.size() - HOST_FIFO_DEPTH].start;
+    if (room > enter) enter = room;
+  }
+  uint64_t start = enter > s.busyUntil ? enter : s.busyUntil;
+  s.busyUntil = start + wordBits(s.config) * bitNs(s.config);
+  s.fifo.push_back({enter, start});
+  decode(s.config, data, start);
+  writes++;
+  return enter;
+}
+
+StateMachine &stateMachine(PIO pio, uint sm) {
+  return sms[pio_get_index(pio)][sm];
+}
+
+uint64_t nextEvent(void) {
+  uint64_t next = HOST_NEVER;
+  for (const Channel &c : channels) if (c.active && c.doneAt < next) next = c.doneAt;
+  return next;
+}
+
+// Run the DMA IRQ handlers while a channel has its interrupt pending, as
+// this core would once it has DMA_IRQ_0 enabled.
+void service(void) {
+  if (masked || inHandler) return;
+  for (int pass = 0 ; pass < 8 ; pass++) {
+    std::vector<irq_handler_t> run;
+    {
+      ModelGuard guard;
+      bool pending = false;
+      for (const Channel &c : channels) pending |= c.irqEnabled && c.irqRaw;
+      if (!pending || !nvicEnabled[coreNum][DMA_IRQ_0]) return;
+      run = handlers[DMA_IRQ_0];
+    }
+    inHandler = true;
+    for (irq_handler_t h : run) h();
+    inHandler = false;
+  }
+}
+
+// Move the clock to t, finishing transfers and taking their interrupts
+// in order on the way.
+void advanceTo(uint64_t t) {
+  for (;;) {
+    {
+      ModelGuard guard;
+      uint64_t next = nextEvent();
+      if (next > t) {
+        uint64_t now = clockNs;
+        while (t > now && !clockNs.compare_exchange_weak(now, t)) ;
+        break;
+      }
+      uint64_t now = clockNs;
+      while (next > now && !clockNs.compare_exchange_weak(now, next)) ;
+      for (Channel &c : channels) {
+        if (c.active && c.doneAt <= next) {
+          c.active = false;
+          c.irqRaw = true;
+        }
+      }
+    }
+    service();
+  }
+  service();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// NeoPixelHost
+
+/*!
+  @brief   The fake clock, in nanoseconds since boot.
+*/
+uint64_t NeoPixelHost::now(void) {
+  return clockNs;
+}
+
+/*!
+  @brief   Let time pass, finishing transfers that end before it's up.
+  @param   us  Microseconds.
+*/
+void NeoPixelHost::advance(uint64_t us) {
+  advanceTo(clockNs + us * 1000);
+}
+
+/*!
+  @brief   Let time pass until every transfer has finished and every pin
+           has been idle long enough to latch its last frame.
+*/
+void NeoPixelHost::settle(void) {
+  uint64_t until = clockNs;
+  {
+    ModelGuard guard;
+    for (const Channel &c : channels) if (c.active && c.doneAt > until) until = c.doneAt;
+    for (auto &pio : sms) for (const StateMachine &s : pio) if (s.busyUntil > until) until = s.busyUntil;
+  }
+  advanceTo(until + NEOPIXEL_HOST_FRAME_GAP_US * 1000ull);
+  ModelGuard guard;
+  for (auto &l : lanes) if (l.second.open) latch(l.second);
+}
+
+/*!
+  @brief   The virtual strip on a pin. Its last frame shows once the line
+           has been idle for NEOPIXEL_HOST_FRAME_GAP_US.
+  @param   gpio  Pin number.
+*/
+const NeoPixelHostPin &NeoPixelHost::pin(uint gpio) {
+  ModelGuard guard;
+  Lane &l = lanes[gpio];
+  if (l.open && clockNs >= l.frame.endNs + NEOPIXEL_HOST_FRAME_GAP_US * 1000ull) latch(l);
+  return l.pin;
+}
+
+/*!
+  @brief   Forget every frame received so far, and what the strips show.
+*/
+void NeoPixelHost::clearPins(void) {
+  ModelGuard guard;
+  lanes.clear();
+}
+
+/*!
+  @brief   Words written into any TX FIFO, by the CPU or by DMA.
+*/
+uint32_t NeoPixelHost::fifoWrites(void) {
+  return writes;
+}
+
+/*!
+  @brief   Calls to malloc, calloc, realloc and operator new so far, not
+           counting the model's own.
+*/
+uint32_t NeoPixelHost::allocations(void) {
+  return allocs;
+}
+
+/*!
+  @brief   Make the next allocations fail, to test out of memory paths.
+  @param   n  Number of calls to malloc, calloc or realloc to fail.
+*/
+void NeoPixelHost::failAllocations(uint32_t n) {
+  failing = n;
+}
+
+/*!
+  @brief   State machines of a PIO nobody has claimed.
+*/
+uint8_t NeoPixelHost::freeStateMachines(PIO pio) {
+  ModelGuard guard;
+  uint8_t n = 0;
+  for (const StateMachine &s : sms[pio_get_index(pio)]) n += !s.claimed;
+  return n;
+}
+
+/*!
+  @brief   Instruction slots of a PIO no loaded program uses.
+*/
+uint8_t NeoPixelHost::freeInstructions(PIO pio) {
+  ModelGuard guard;
+  return PIO_INSTRUCTION_COUNT - __builtin_popcount(programSlots[pio_get_index(pio)]);
+}
+
+/*!
+  @brief   DMA channels claimed.
+*/
+uint8_t NeoPixelHost::claimedDmaChannels(void) {
+  ModelGuard guard;
+  uint8_t n = 0;
+  for (const Channel &c : channels) n += c.claimed;
+  return n;
+}
+
+/*!
+  @brief   Whether core has interrupt num enabled in its NVIC.
+*/
+bool NeoPixelHost::irqEnabled(uint core, uint num) {
+  ModelGuard guard;
+  return nvicEnabled[core][num];
+}
+
+// ---------------------------------------------------------------------------
+// pico_time, pico_multicore, hardware_sync
+
+extern "C" {
+
+uint64_t time_us_64(void) {
+  return clockNs / 1000;
+}
+
+void sleep_us(uint64_t us) {
+  advanceTo(clockNs + us * 1000);
+}
+
+void sleep_until(absolute_time_t t) {
+  advanceTo(t * 1000);
+}
+
+void busy_wait_us(uint64_t us) {
+  advanceTo(clockNs + us * 1000);
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout) {
+  uint64_t t = timeout * 1000;
+  uint64_t next;
+  {
+    ModelGuard guard;
+    next = nextEvent();
+  }
+  if (next < t) {
+    advanceTo(next);
+    return false;
+  }
+  advanceTo(t);
+  return true;
+}
+
+void tight_loop_contents(void) {
+  if (core1Running) std::this_thread::yield();
+  advanceTo(clockNs + 1000);
+}
+
+uint get_core_num(void) {
+  return coreNum;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+  if (core1.joinable()) core1.join();
+  core1Running = true;
+  core1 = std::thread([entry]() {
+    coreNum = 1;
+    entry();
+  });
+}
+
+void multicore_reset_core1(void) {
+  // the loop on core 1 has been told to stop; a thread can't be killed
+  if (core1.joinable()) core1.join();
+  core1Running = false;
+}
+
+void __sev(void) {
+}
+
+void __wfe(void) {
+  std::this_thread::yield();
+  tight_loop_contents();
+}
+
+uint32_t save_and_disable_interrupts(void) {
+  uint32_t was = masked;
+  masked = true;
+  return was;
+}
+
+void restore_interrupts(uint32_t status) {
+  masked = status != 0;
+  if (!masked) service();
+}
+
+spin_lock_t *spin_lock_instance(uint lock_num) {
+  if (lock_num >= 32) panic("spin lock %u out of range", lock_num);
+  return &spinLocks[lock_num];
+}
+
+void spin_lock_claim(uint lock_num) {
+  ModelGuard guard;
+  if (spinLocksClaimed & (1u << lock_num)) panic("spin lock %u already claimed", lock_num);
+  spinLocksClaimed |= 1u << lock_num;
+}
+
+void spin_lock_unclaim(uint lock_num) {
+  ModelGuard guard;
+  spinLocksClaimed &= ~(1u << lock_num);
+}
+
+int spin_lock_claim_unused(bool required) {
+  ModelGuard guard;
+  for (uint n = PICO_SPINLOCK_ID_CLAIM_FREE_FIRST ; n <= PICO_SPINLOCK_ID_CLAIM_FREE_LAST ; n++) {
+    if (!(spinLocksClaimed & (1u << n))) {
+      spinLocksClaimed |= 1u << n;
+      return (int)n;
+    }
+  }
+  if (required) panic("no spin lock free");
+  return -1;
+}
+
+bool spin_lock_is_claimed(uint lock_num) {
+  ModelGuard guard;
+  return spinLocksClaimed & (1u << lock_num);
+}
+
+void critical_section_init(critical_section_t *crit_sec) {
+  uint n = PICO_SPINLOCK_ID_STRIPED_FIRST +
+           nextStriped++ % (PICO_SPINLOCK_ID_STRIPED_LAST - PICO_SPINLOCK_ID_STRIPED_FIRST + 1);
+  crit_sec->spin_lock = spin_lock_instance(n);
+}
+
+void critical_section_enter_blocking(critical_section_t *crit_sec) {
+  // interrupts stay off until the matching exit
+  save_and_disable_interrupts();
+  spin_lock_unsafe_blocking(crit_sec->spin_lock);
+}
+
+void critical_section_exit(critical_section_t *crit_sec) {
+  spin_unlock_unsafe(crit_sec->spin_lock);
+  restore_interrupts(0);
+}
+
+void critical_section_deinit(critical_section_t *crit_sec) {
+  crit_sec->spin_lock = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// hardware_pio
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+  ModelGuard guard;
+  for (uint sm = 0 ; sm < NUM_PIO_STATE_MACHINES ; sm++) {
+    StateMachine &s = stateMachine(pio, sm);
+    if (!s.claimed) {
+      s.claimed = true;
+      return sm;
+    }
+  }
+  if (required) panic("No PIO state machines are available");
+  return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+  ModelGuard guard;
+  StateMachine &s = stateMachine(pio, sm);
+  if (s.claimed) panic("PIO %u SM %u already claimed", pio_get_index(pio), sm);
+  s.claimed = true;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+  ModelGuard guard;
+  stateMachine(pio, sm).claimed = false;
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm) {
+  ModelGuard guard;
+  return stateMachine(pio, sm).claimed;
+}
+
+// the SDK loads programs at the highest free offset
+static int findOffset(PIO pio, const pio_program_t *program) {
+  uint32_t used = programSlots[pio_get_index(pio)];
+  uint32_t mask = (program->length >= 32) ? 0xFFFFFFFFu : ((1u << program->length) - 1);
+  if (program->origin >= 0) {
+    if (program->origin + program->length > PIO_INSTRUCTION_COUNT) return -1;
+    return (used & (mask << program->origin)) ? -1 : program->origin;
+  }
+  for (int offset = PIO_INSTRUCTION_COUNT - program->length ; offset >= 0 ; offset--) {
+    if (!(used & (mask << offset))) return offset;
+  }
+  return -1;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program) {
+  ModelGuard guard;
+  return findOffset(pio, program) >= 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+  ModelGuard guard;
+  int offset = findOffset(pio, program);
+  if (offset < 0) panic("No program space");
+  programSlots[pio_get_index(pio)] |= ((1u << program->length) - 1) << offset;
+  return offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset) {
+  ModelGuard guard;
+  uint32_t mask = ((1u << program->length) - 1) << loaded_offset;
+  if ((programSlots[pio_get_index(pio)] & mask) != mask) panic("Program not loaded at %u", loaded_offset);
+  programSlots[pio_get_index(pio)] &= ~mask;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+  (void)pio;
+  (void)pin;
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+  (void)pio;
+  (void)sm;
+  (void)pin_base;
+  (void)pin_count;
+  (void)is_out;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {
+  (void)initial_pc;
+  ModelGuard guard;
+  StateMachine &s = stateMachine(pio, sm);
+  prune(s);
+  s.config = *config;
+  // words not pulled yet are lost, as the FIFOs are cleared
+  while (!s.fifo.empty() && s.fifo.back().enter <= clockNs) s.fifo.pop_back();
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+  (void)pio;
+  (void)sm;
+  (void)enabled;
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) {
+  ModelGuard guard;
+  StateMachine &s = stateMachine(pio, sm);
+  prune(s);
+  while (!s.fifo.empty() && s.fifo.back().enter <= clockNs) s.fifo.pop_back();
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+  ModelGuard guard;
+  StateMachine &s = stateMachine(pio, sm);
+  if (level(s) < HOST_FIFO_DEPTH) enqueue(s, data, clockNs); // else lost
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+  for (;;) {
+    uint64_t room;
+    {
+      ModelGuard guard;
+      StateMachine &s = stateMachine(pio, sm);
+      if (level(s) < HOST_FIFO_DEPTH) {
+        enqueue(s, data, clockNs);
+        return;
+      }
+      room = s.fifo.front().start;
+    }
+    advanceTo(room);
+  }
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) {
+  ModelGuard guard;
+  return level(stateMachine(pio, sm));
+}
+
+// ---------------------------------------------------------------------------
+// hardware_dma
+
+int dma_claim_unused_channel(bool required) {
+  ModelGuard guard;
+  for (uint ch = 0 ; ch < NUM_DMA_CHANNELS ; ch++) {
+    if (!channels[ch].claimed) {
+      channels[ch].claimed = true;
+      return ch;
+    }
+  }
+  if (required) panic("No DMA channels are available");
+  return -1;
+}
+
+void dma_channel_claim(uint channel) {
+  ModelGuard guard;
+  if (channels[channel].claimed) panic("DMA channel %u already claimed", channel);
+  channels[channel].claimed = true;
+}
+
+void dma_channel_unclaim(uint channel) {
+  ModelGuard guard;
+  channels[channel].claimed = false;
+}
+
+bool dma_channel_is_claimed(uint channel) {
+  ModelGuard guard;
+  return channels[channel].claimed;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  (void)channel;
+  dma_channel_config c = {DMA_SIZE_32, true, false, false, 0x3f};
+  return c;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+  {
+    ModelGuard guard;
+    Channel &c = channels[channel];
+    c.config = *config;
+    c.pio = c.sm = -1;
+    for (int p = 0 ; p < NUM_PIOS ; p++) {
+      for (int sm = 0 ; sm < NUM_PIO_STATE_MACHINES ; sm++) {
+        if (write_addr == &neopixel_host_pio_hw[p].txf[sm]) {
+          c.pio = p;
+          c.sm = sm;
+        }
+      }
+    }
+  }
+  if (trigger) dma_channel_transfer_from_buffer_now(channel, read_addr, transfer_count);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+  ModelGuard guard;
+  Channel &c = channels[channel];
+  if (c.active) panic("DMA channel %u triggered while busy", channel);
+  uint64_t t = clockNs;
+  const volatile uint8_t *src = (const volatile uint8_t *)read_addr;
+  uint size = 1u << c.config.size;
+  for (uint32_t i = 0 ; i < transfer_count ; i++) {
+    const volatile uint8_t *p = src + (c.config.read_increment ? i * size : 0);
+    uint32_t data = (size == 4) ? *(const volatile uint32_t *)p
+                  : (size == 2) ? *(const volatile uint16_t *)p : *p;
+    if (c.config.bswap) data = (size == 4) ? __builtin_bswap32(data)
+                             : (size == 2) ? __builtin_bswap16((uint16_t)data) : data;
+    if (c.pio != -1) t = enqueue(sms[c.pio][c.sm], data, t);
+  }
+  c.active = true;
+  c.doneAt = t;
+}
+
+bool dma_channel_is_busy(uint channel) {
+  ModelGuard guard;
+  const Channel &c = channels[channel];
+  return c.active && c.doneAt > clockNs;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  uint64_t t;
+  {
+    ModelGuard guard;
+    const Channel &c = channels[channel];
+    if (!c.active) return;
+    t = c.doneAt;
+  }
+  advanceTo(t);
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+  ModelGuard guard;
+  channels[channel].irqEnabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+  ModelGuard guard;
+  return channels[channel].irqEnabled && channels[channel].irqRaw;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+  ModelGuard guard;
+  channels[channel].irqRaw = false;
+}
+
+// ---------------------------------------------------------------------------
+// hardware_irq
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+  (void)order_priority;
+  ModelGuard guard;
+  handlers[num].push_back(handler);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+  ModelGuard guard;
+  std::vector<irq_handler_t> &h = handlers[num];
+  for (auto i = h.begin() ; i != h.end() ; ++i) {
+    if (*i == handler) {
+      h.erase(i);
+      break;
+    }
+  }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+  {
+    ModelGuard guard;
+    nvicEnabled[coreNum][num] = enabled;
+  }
+  service();
+}
+
+// ---------------------------------------------------------------------------
+// pico_malloc: targets linking the host SDK wrap the allocator, as
+// pico_malloc does, so tests can count allocations.
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *mem, size_t size);
+
+static bool failAllocation(void) {
+  uint32_t n = failing;
+  while (n && !failing.compare_exchange_weak(n, n - 1)) ;
+  return n != 0;
+}
+
+void *__wrap_malloc(size_t size) {
+  if (modelDepth) return __real_malloc(size);
+  allocs++;
+  return failAllocation() ? NULL : __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  if (modelDepth) return __real_calloc(count, size);
+  allocs++;
+  return failAllocation() ? NULL : __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *mem, size_t size) {
+  if (modelDepth) return __real_realloc(mem, size);
+  allocs++;
+  return failAllocation() ? NULL : __real_realloc(mem, size);
+}
+
+} // extern "C"
+
+void *operator new(size_t size) {
+  void *p = malloc(size ? size : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
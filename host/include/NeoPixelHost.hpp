@@ -0,0 +1,59 @@
+/*!
+ * @file NeoPixelHost.hpp
+ *
+ * Test side of the host build: the fake clock the stub SDK runs on and the
+ * virtual LED strips that decode what the state machines send.
+ *
+ */
+
+#pragma once
+#include "hardware/pio.h"
+#include <stdint.h>
+#include <vector>
+
+#define NEOPIXEL_HOST_FRAME_GAP_US 50 ///< idle time that ends a frame on the wire
+
+/*!
+    @brief  One frame as it left a pin: everything sent without the line
+            going idle for NEOPIXEL_HOST_FRAME_GAP_US.
+*/
+struct NeoPixelHostFrame {
+  uint64_t             startNs;  ///< first bit starts
+  uint64_t             endNs;    ///< last bit ends
+  uint64_t             gapNs;    ///< idle time since the previous frame, UINT64_MAX for the first
+  uint64_t             stallNs;  ///< longest stall inside the frame, from an empty FIFO
+  std::vector<uint8_t> bytes;    ///< data bytes in wire order
+};
+
+/*!
+    @brief  A virtual strip on one pin. A frame is latched once the line
+            has been idle long enough; it then overwrites the first
+            bytes of leds, like real pixels passing on the rest.
+*/
+struct NeoPixelHostPin {
+  std::vector<NeoPixelHostFrame> frames; ///< latched frames, oldest first
+  std::vector<uint8_t>           leds;   ///< bytes the pixels currently show
+};
+
+/*!
+    @brief  Controls the stub SDK. Time only moves when the code under
+            test sleeps or waits, or when a test calls advance().
+*/
+class NeoPixelHost {
+
+ public:
+
+  static uint64_t               now(void);
+  static void                   advance(uint64_t us);
+  static void                   settle(void);
+  static const NeoPixelHostPin &pin(uint gpio);
+  static void                   clearPins(void);
+  static uint32_t               fifoWrites(void);
+  static uint32_t               allocations(void);
+  static void                   failAllocations(uint32_t n);
+  static uint8_t                freeStateMachines(PIO pio);
+  static uint8_t                freeInstructions(PIO pio);
+  static uint8_t                claimedDmaChannels(void);
+  static bool                   irqEnabled(uint core, uint num);
+
+};
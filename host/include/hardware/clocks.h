@@ -0,0 +1,7 @@
+#pragma once
+#include "pico/stdio.h"
+
+enum clock_index { clk_gpout0 = 0, clk_ref = 4, clk_sys = 5, clk_peri = 6 };
+
+// the fake system clock runs at the default 125 MHz
+static inline uint32_t clock_get_hz(enum clock_index clk_index) { (void)clk_index; return 125000000; }
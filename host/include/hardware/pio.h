@@ -0,0 +1,95 @@
+#pragma once
+#include "pico/stdio.h"
+
+// Two PIO blocks of four state machines and 32 instruction slots. Words put
+// into a TX FIFO are shifted out on the fake clock and decoded into bytes
+// per pin, see NeoPixelHost.hpp.
+
+#define NUM_PIOS 2
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+typedef struct {
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+typedef struct {
+    uint8_t out_base;
+    uint8_t out_count;      // 0 unless the program drives pins with out/mov
+    uint8_t sideset_base;
+    uint8_t sideset_count;  // 0 unless the program drives a pin by side-set
+    bool shift_right;
+    bool autopull;
+    uint8_t pull_threshold;
+    uint8_t bit_cycles;     // clock cycles per data bit, from the program
+    float clkdiv;
+} pio_sm_config;
+
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE = 0, PIO_FIFO_JOIN_TX = 1, PIO_FIFO_JOIN_RX = 2 };
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern pio_hw_t neopixel_host_pio_hw[NUM_PIOS];
+
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint loaded_offset);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define pio0 (&neopixel_host_pio_hw[0])
+#define pio1 (&neopixel_host_pio_hw[1])
+
+static inline uint pio_get_index(PIO pio) { return pio == pio1 ? 1 : 0; }
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { return pio_get_index(pio) * 8 + (is_tx ? 0 : 4) + sm; }
+static inline bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) { return pio_sm_get_tx_fifo_level(pio, sm) >= 8; }
+static inline bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) { return pio_sm_get_tx_fifo_level(pio, sm) == 0; }
+
+static inline pio_sm_config pio_get_default_sm_config(void) {
+    pio_sm_config c = {0, 0, 0, 0, true, false, 32, 1, 1.0f};
+    return c;
+}
+
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint out_base, uint out_count) {
+    c->out_base = (uint8_t)out_base;
+    c->out_count = (uint8_t)out_count;
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) {
+    c->sideset_base = (uint8_t)sideset_base;
+    c->sideset_count = 1;
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = (uint8_t)pull_threshold;
+}
+
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { (void)c; (void)join; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) { c->clkdiv = div; }
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) { (void)c; (void)wrap_target; (void)wrap; }
@@ -0,0 +1,57 @@
+#pragma once
+#include "pico/stdio.h"
+
+// The 32 hardware spin locks are plain words taken with an atomic exchange.
+// Disabling interrupts holds back the fake DMA completion interrupt.
+
+typedef volatile uint32_t spin_lock_t;
+
+#define PICO_SPINLOCK_ID_IRQ 9
+#define PICO_SPINLOCK_ID_TIMER 10
+#define PICO_SPINLOCK_ID_HARDWARE_CLAIM 11
+#define PICO_SPINLOCK_ID_STRIPED_FIRST 16
+#define PICO_SPINLOCK_ID_STRIPED_LAST 23
+#define PICO_SPINLOCK_ID_CLAIM_FREE_FIRST 24
+#define PICO_SPINLOCK_ID_CLAIM_FREE_LAST 31
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void __sev(void);
+void __wfe(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+spin_lock_t *spin_lock_instance(uint lock_num);
+void spin_lock_claim(uint lock_num);
+void spin_lock_unclaim(uint lock_num);
+int spin_lock_claim_unused(bool required);
+bool spin_lock_is_claimed(uint lock_num);
+uint get_core_num(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __compiler_memory_barrier(void) { __asm__ volatile ("" : : : "memory"); }
+
+static inline void spin_lock_unsafe_blocking(spin_lock_t *lock) {
+    while (__atomic_exchange_n(lock, 1u, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static inline void spin_unlock_unsafe(spin_lock_t *lock) {
+    __atomic_store_n(lock, 0u, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock) {
+    uint32_t save = save_and_disable_interrupts();
+    spin_lock_unsafe_blocking(lock);
+    return save;
+}
+
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq) {
+    spin_unlock_unsafe(lock);
+    restore_interrupts(saved_irq);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "pico/stdio.h"
+
+// Core 1 is a host thread.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+
+#ifdef __cplusplus
+}
+#endif
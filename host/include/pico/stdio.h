@@ -0,0 +1,22 @@
+// Host stand-in for the Pico SDK, used by the NEOPIXEL_HOST build. Only
+// what the library needs is declared.
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+
+#define NUM_CORES 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// lets the fake clock move on while code spins on a flag
+void tight_loop_contents(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+#pragma once
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
@@ -0,0 +1,19 @@
+#pragma once
+#include "hardware/sync.h"
+
+typedef struct {
+    spin_lock_t *spin_lock;
+} critical_section_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void critical_section_init(critical_section_t *crit_sec);
+void critical_section_enter_blocking(critical_section_t *crit_sec);
+void critical_section_exit(critical_section_t *crit_sec);
+void critical_section_deinit(critical_section_t *crit_sec);
+
+#ifdef __cplusplus
+}
+#endif
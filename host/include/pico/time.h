@@ -0,0 +1,31 @@
+#pragma once
+#include "pico/stdio.h"
+
+// Time runs on the fake clock of NeoPixelHost: it only moves when code
+// sleeps, spins or waits for the hardware.
+
+typedef uint64_t absolute_time_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t time_us_64(void);
+void sleep_us(uint64_t us);
+void sleep_until(absolute_time_t t);
+void busy_wait_us(uint64_t us);
+bool best_effort_wfe_or_timeout(absolute_time_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline void update_us_since_boot(absolute_time_t *t, uint64_t us) { *t = us; }
+static inline absolute_time_t from_us_since_boot(uint64_t us) { return us; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return time_us_64() + us; }
+static inline void sleep_ms(uint32_t ms) { sleep_us((uint64_t)ms * 1000); }
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# Stand-in for pioasm in the host build. Emits the header pioasm would,
+# with the program's length, public defines and c-sdk block, but no
+# machine code: the stub SDK never runs it. A program that defines the
+# public T1, T2 and T3 of the ws2812 programs gets T1 + T2 + T3 cycles per
+# bit in its default config, which is what the stub shifts words out at.
+#
+# usage: pio_header.py <input.pio> <output.pio.h>
+
+import os
+import re
+import sys
+
+
+def parse(text):
+    programs = []
+    prog = None
+    in_c_sdk = False
+    for line in text.splitlines():
+        if in_c_sdk:
+            if line.strip() == '%}':
+                in_c_sdk = False
+            else:
+                prog['c_sdk'].append(line)
+            continue
+        code = line.split(';', 1)[0].strip()
+        if not code:
+            continue
+        if code.startswith('% c-sdk'):
+            in_c_sdk = True
+            continue
+        m = re.match(r'\.program\s+(\w+)', code)
+        if m:
+            prog = {'name': m.group(1), 'length': 0, 'defines': [], 'c_sdk': []}
+            programs.append(prog)
+            continue
+        if prog is None:
+            continue
+        m = re.match(r'\.define\s+public\s+(\w+)\s+(\S+)', code)
+        if m:
+            prog['defines'].append((m.group(1), m.group(2)))
+            continue
+        if code.startswith('.'):
+            continue
+        code = re.sub(r'^\w+:', '', code).strip()  # label
+        if code:
+            prog['length'] += 1
+    return programs
+
+
+def main():
+    src, out = sys.argv[1], sys.argv[2]
+    with open(src) as f:
+        programs = parse(f.read())
+    lines = ['// Generated by host/pio_header.py from %s, do not edit.' % os.path.basename(src),
+             '',
+             '#pragma once',
+             '',
+             '#include "hardware/pio.h"',
+             '']
+    for p in programs:
+        name = p['name']
+        defines = dict(p['defines'])
+        lines.append('#define %s_wrap_target 0' % name)
+        lines.append('#define %s_wrap %d' % (name, p['length'] - 1))
+        for key, value in p['defines']:
+            lines.append('#define %s_%s %s' % (name, key, value))
+        lines.append('')
+        lines.append('static const uint16_t %s_program_instructions[%d] = {0};' % (name, p['length']))
+        lines.append('')
+        lines.append('static const pio_program_t %s_program = {' % name)
+        lines.append('    %s_program_instructions, %d, -1' % (name, p['length']))
+        lines.append('};')
+        lines.append('')
+        lines.append('static inline pio_sm_config %s_program_get_default_config(uint offset) {' % name)
+        lines.append('    (void)offset;')
+        lines.append('    pio_sm_config c = pio_get_default_sm_config();')
+        if all(t in defines for t in ('T1', 'T2', 'T3')):
+            lines.append('    c.bit_cycles = %s_T1 + %s_T2 + %s_T3;' % (name, name, name))
+        lines.append('    return c;')
+        lines.append('}')
+        lines.extend(p['c_sdk'])
+        lines.append('')
+    with open(out, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()
@@ -6,6 +6,34 @@
 #include <vector>
 #include <tuple>
 #include "Adafruit_NeoPixel.hpp"
+#include "pico_neopixel_trace.h"
+#include "NeoPixelStats.hpp"
+#include "timelines/gamecube_startup.h"
+
+//#define ANIM_DEBUG0 // state changes and endpoint calls
+//#define ANIM_DEBUG1 // per pixel, per frame
+//#define ANIM_TRACE  // log enabled levels to the trace ring, not stdio
+
+// ANIM_PRINTFn(event, a, b, format, ...) prints the format, or with 
+// ANIM_TRACE records event, a and b for neopixel_trace_dump(). Disabled 
+// levels compile to nothing, arguments included.
+#if defined(ANIM_TRACE)
+#define ANIM_LOG(event, a, b, ...) neopixel_trace(event, a, b)
+#else
+#define ANIM_LOG(event, a, b, ...) printf(__VA_ARGS__)
+#endif
+
+#ifdef ANIM_DEBUG0
+#define ANIM_PRINTF0(...) ANIM_LOG(__VA_ARGS__)
+#else
+#define ANIM_PRINTF0(...)
+#endif
+
+#ifdef ANIM_DEBUG1
+#define ANIM_PRINTF1(...) ANIM_LOG(__VA_ARGS__)
+#else
+#define ANIM_PRINTF1(...)
+#endif
 
 //  adding constructor so we don't have to copy an Adafruit_NeoPixel  object
 
@@ -30,10 +58,21 @@ NeoPixelStrip::NeoPixelStrip(
     //TODO: Make setPixelOrder function checking for blank string or breaking
     //      the string into the appropriate number of pieces
 {
+    setup(pixelOrderString);
+}
+
+void NeoPixelStrip::setup(const std::string &pixelOrderString) {
+    // Size the tables once, so a NeoPixelStripStorage arena is enough
+    pixelOrder.reserve(strip.numPixels());
+    electricalOrder.reserve(strip.numPixels());
+    pixelColors.reserve(strip.numPixels());
     // INITIALIZE NeoPixel strip
     interpretPixelOrder(pixelOrderString);
     initializePixelColors(strip.Color(255, 255, 255), strip.Color(255, 30, 35));
     strip.begin();            
+    // Only keep the colors as set; brightness is applied on transmission,
+    // so fades rescale every pixel without touching the buffer
+    strip.setBrightnessOnShow(true);
     strip.setBrightnessFunctions(
             adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
         );
@@ -46,7 +85,9 @@ uint8_t NeoPixelStrip::brightness=0;
 
 // delay() function -- wait a number of milliseconds
 void NeoPixelStrip::delay(uint32_t ms) {
+    NEOPIXEL_STATS_START(start);
     sleep_ms(ms);
+    NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_SLEEP, start);
 }
 
 // "Unpacks" a packed 32-bit RGB value into its components
@@ -68,27 +109,25 @@ uint32_t NeoPixelStrip::packColor(
 }
 
 uint16_t NeoPixelStrip::parseOrder(uint16_t value) {
-    uint16_t j;
-    for (int i=0; i<strip.numPixels(); i++) {
-        if (pixelOrder[i] == value) {
-            j = i;
-        }
+    // Positions missing from the order string map onto themselves
+    if (value >= electricalOrder.size()) {
+        return value;
     }
-    //printf("pixelOrder Index: %d\n", j);
-    return j;
+    return electricalOrder[value];
 }
 
 uint16_t NeoPixelStrip::parseSpeed(uint8_t speed){
-    printf("Speed Parsing. Intial Value: %d\n", speed);
     uint16_t new_speed = uint16_t((101-speed));
-    printf("Speed Parsing. Altered Value: %d\n", new_speed);
+    ANIM_PRINTF0(TRACE_PARSE_SPEED, speed, new_speed,
+        "Speed Parsing. Intial Value: %d, Altered Value: %d\n", speed, new_speed);
     return new_speed;
 }
 
 uint8_t NeoPixelStrip::parseBrightness(int slider_value){
-    printf("Brightness Parsing. Intial Value: %d\n", slider_value);
     uint8_t new_brightness = slider_value * 2.5;
-    printf("Brightness Parsing. Altered Value: %d\n", new_brightness);
+    ANIM_PRINTF0(TRACE_PARSE_BRIGHTNESS, slider_value, new_brightness,
+        "Brightness Parsing. Intial Value: %d, Altered Value: %d\n", 
+        slider_value, new_brightness);
     return new_brightness;
 }
 
@@ -103,24 +142,176 @@ void NeoPixelStrip::syncStateWithVector() {
     led_3 = pixelColors[2];
     led_4 = pixelColors[3];
     led_power = pixelColors[4];
-    printf("Pwr: %x led1: %x led2: %x led3: %x led4: %x\n",led_power, led_1, led_2, led_3, led_4);
+    ANIM_PRINTF0(TRACE_STATE_COLORS, led_power, led_1,
+        "Pwr: %x led1: %x led2: %x led3: %x led4: %x\n",
+        led_power, led_1, led_2, led_3, led_4);
 }
 
 void NeoPixelStrip::updateStateColors() {
-    //New Vector to replace current color vector
-    std::vector<uint32_t> newPixelColors;
-    // Sync Pixel Colors(returns undimmed value)
+    // Sync Pixel Colors(returns undimmed value), in visual order. Only 
+    // grows the vector the first time, so no allocation per sync.
+    pixelColors.resize(strip.numPixels());
     for (int i=0; i<strip.numPixels(); i++) {
-        for (int j=0; j<strip.numPixels(); j++) {
-            if (pixelOrder[j] == i) {
-                newPixelColors.push_back(strip.getPixelColor(j));
-                printf("pixelColor%d: %d newPixelColor%d: %d\n", 
-               i, pixelColors[i], i, newPixelColors[i]);
+        pixelColors[i] = strip.getPixelColor(parseOrder(i));
+    }
+    stateDirtyFirst = stateDirtyEnd = 0;
+    syncStateWithVector();
+}
+
+void NeoPixelStrip::markStateDirty(uint16_t visual) {
+    if (visual >= strip.numPixels()) {
+        return;
+    }
+    if (stateDirtyFirst == stateDirtyEnd) {
+        stateDirtyFirst = visual;
+        stateDirtyEnd = visual + 1;
+    } else if (visual < stateDirtyFirst) {
+        stateDirtyFirst = visual;
+    } else if (visual >= stateDirtyEnd) {
+        stateDirtyEnd = visual + 1;
+    }
+}
+
+void NeoPixelStrip::syncDirtyStateColors() {
+    pixelColors.resize(strip.numPixels());
+    for (int i=stateDirtyFirst; i<stateDirtyEnd; i++) {
+        pixelColors[i] = strip.getPixelColor(parseOrder(i));
+    }
+    stateDirtyFirst = stateDirtyEnd = 0;
+    syncStateWithVector();
+}
+
+void NeoPixelStrip::syncStateColor(uint16_t visual) {
+    if (visual < pixelColors.size()) {
+        pixelColors[visual] = strip.getPixelColor(parseOrder(visual));
+    }
+}
+
+// Frame view ---------------------------------------------------
+
+NeoPixelStrip::FrameView NeoPixelStrip::frame() {
+    uint16_t count = strip.numPixels();
+    if (electricalOrder.size() < count) {
+        count = electricalOrder.size();
+    }
+    return FrameView(strip, electricalOrder.data(), count);
+}
+
+NeoPixelStrip::FrameView::FrameView(
+    Adafruit_NeoPixel &strip, const uint16_t *order, uint16_t count
+):
+    strip(&strip), pixels(strip.getPixels()), order(order), 
+    count(pixels ? count : 0)
+{
+    // Same decoding as Adafruit_NeoPixel::updateType()
+    neoPixelType type = strip.getType();
+    wOffset = (type >> 6) & 0b11;
+    rOffset = (type >> 4) & 0b11;
+    gOffset = (type >> 2) & 0b11;
+    bOffset = type & 0b11;
+    bpp = (wOffset == rOffset) ? 3 : 4;
+}
+
+void NeoPixelStrip::FrameView::store(uint8_t *p, uint32_t color) const {
+    if (bpp == 4) {
+        p[wOffset] = color >> 24;
+    }
+    p[rOffset] = color >> 16;
+    p[gOffset] = color >> 8;
+    p[bOffset] = color;
+}
+
+uint32_t NeoPixelStrip::FrameView::load(const uint8_t *p) const {
+    uint32_t color = ((uint32_t)p[rOffset] << 16) |
+        ((uint32_t)p[gOffset] << 8) | p[bOffset];
+    if (bpp == 4) {
+        color |= (uint32_t)p[wOffset] << 24;
+    }
+    return color;
+}
+
+void NeoPixelStrip::FrameView::set(uint16_t i, uint32_t color) {
+    if (i < count) {
+        store(touch(i), color);
+    }
+}
+
+uint32_t NeoPixelStrip::FrameView::get(uint16_t i) const {
+    if (i >= count) {
+        return 0;
+    }
+    return load(at(i));
+}
+
+void NeoPixelStrip::FrameView::fill_range(
+    uint16_t first, uint16_t n, uint32_t color
+){
+    if (first >= count) {
+        return;
+    }
+    uint16_t end = (n > count - first) ? count : first + n;
+    // Build the pixel once, then copy its bytes
+    uint8_t wire[4];
+    store(wire, color);
+    for (uint16_t i=first; i<end; i++) {
+        uint8_t *p = touch(i);
+        for (uint8_t b=0; b<bpp; b++) {
+            p[b] = wire[b];
+        }
+    }
+}
+
+void NeoPixelStrip::FrameView::copy_from(
+    const uint32_t *colors, uint16_t n, uint16_t first
+){
+    if (first >= count) {
+        return;
+    }
+    uint16_t end = (n > count - first) ? count : first + n;
+    for (uint16_t i=first; i<end; i++) {
+        store(touch(i), colors[i - first]);
+    }
+}
+
+void NeoPixelStrip::FrameView::blend_from(
+    const uint32_t *colors, uint16_t n, uint8_t amount, uint16_t first
+){
+    if (first >= count) {
+        return;
+    }
+    uint16_t end = (n > count - first) ? count : first + n;
+    uint8_t wire[4];
+    for (uint16_t i=first; i<end; i++) {
+        uint8_t *p = touch(i);
+        store(wire, colors[i - first]);
+        for (uint8_t b=0; b<bpp; b++) {
+            p[b] += ((int(wire[b]) - int(p[b])) * amount) >> 8;
+        }
+    }
+}
+
+void NeoPixelStrip::FrameView::shift(int n, uint32_t fill) {
+    if (n >= count || -n >= count) {
+        fill_range(0, count, fill);
+        return;
+    }
+    if (n > 0) {
+        for (int i=count-1; i>=n; i--) {
+            uint8_t *dst = touch(i), *src = at(i - n);
+            for (uint8_t b=0; b<bpp; b++) {
+                dst[b] = src[b];
             }
         }
+        fill_range(0, n, fill);
+    } else if (n < 0) {
+        for (int i=0; i<count+n; i++) {
+            uint8_t *dst = touch(i), *src = at(i - n);
+            for (uint8_t b=0; b<bpp; b++) {
+                dst[b] = src[b];
+            }
+        }
+        fill_range(count + n, -n, fill);
     }
-    newPixelColors.swap(pixelColors);
-    syncStateWithVector();
 }
 
 // Initialization Functions -------------------------------------
@@ -128,22 +319,38 @@ void NeoPixelStrip::updateStateColors() {
 // Interprets the initial pixelOrderString string into an appropriate length 
 // Array by breaking the string on each space, then returns the visual index 
 // of the pixel, based on its actual electrical order
-void NeoPixelStrip::interpretPixelOrder(std::string str){
-    std::string f = pixelOrderString;
+void NeoPixelStrip::interpretPixelOrder(const std::string &str){
     std::string word = "";
     for (char x : str) {
         if (x == ' ') {
-            pixelOrder.push_back(std::stoi(word));
+            // entries past the end of the strip would never be used
+            if (pixelOrder.size() < strip.numPixels()) {
+                pixelOrder.push_back(std::stoi(word));
+            }
             word = "";
         } else if (x == 'd') {
-            for (int i=0; i < strip.numPixels(); i++){
+            // the rest of the strip in order, after any explicit entries
+            for (size_t i = pixelOrder.size(); i < strip.numPixels(); i++){
                 pixelOrder.push_back(i);
             }
-            return;
+            break;
         } else {
             word = word + x;
         }
     }
+
+    // Build the visual -> electrical table once, so lookups in the
+    // animation loops don't have to scan pixelOrder. Later entries win,
+    // as they did with the linear scan.
+    electricalOrder.assign(strip.numPixels(), 0);
+    for (int i=0; i < strip.numPixels(); i++){
+        electricalOrder[i] = i;
+    }
+    for (size_t i=0; i < pixelOrder.size() && i < strip.numPixels(); i++){
+        if (pixelOrder[i] >= 0 && pixelOrder[i] < strip.numPixels()) {
+            electricalOrder[pixelOrder[i]] = i;
+        }
+    }
 }
 
 // Takes two uint32_t colors as arguments and sets the 2 colors displayed
@@ -167,7 +374,8 @@ void NeoPixelStrip::initializePixelColors(uint32_t color_1, uint32_t color_2){
 
 // Adjusts the gamme brightness of the neopixels without directly 
 // affecting them or the brightness value itself. Used in 
-// setBrightnessFunctions calls
+// setBrightnessFunctions calls, which evaluate it into a lookup table, so
+// changes of brightness are picked up by strip.updateBrightnessFunctions()
 
 uint8_t NeoPixelStrip::adjustBrightness (uint8_t val) {
 	if (val < 1){
@@ -220,32 +428,79 @@ uint8_t NeoPixelStrip::propStep (
 
 
 
+// One propStep on two bytes at once: a and b hold them in the low byte of
+// each 16-bit half, so the 9-bit intermediate results never carry into the
+// neighbouring lane. min_step, not_lt and big_minus_min are the per-lane
+// constants prepared by propStepPacked().
+static inline uint32_t propStepLanes(
+    uint32_t a, uint32_t b, uint32_t min_step, uint32_t not_lt,
+    uint32_t big_minus_min
+){
+    const uint32_t LANES = 0x00FF00FF, ONES = 0x00010001;
+    // 256 + a - b and 256 + b - a; bit 8 is set when a >= b
+    uint32_t a_minus_b = (a | 0x01000100) - b;
+    uint32_t b_minus_a = (b | 0x01000100) - a;
+    uint32_t ge = (a_minus_b >> 8) & ONES;
+    uint32_t ge_mask = ge * 0xFF;
+    uint32_t difference = ((a_minus_b & ge_mask) | (b_minus_a & ~ge_mask)) & LANES;
+
+    // difference != 0, difference >= min_step, difference == 255
+    uint32_t nonzero = ((difference + LANES) >> 8) & ONES;
+    uint32_t ge_min = ((difference + not_lt) >> 8) & ONES;
+    uint32_t full = ((difference + ONES) >> 8) & ONES;
+
+    // Same choice as propStep(): 1 below min_step, max(max_step, min_step)
+    // across the full range, min_step otherwise, nothing if equal
+    uint32_t ge_min_mask = ge_min * 0xFF;
+    uint32_t step = min_step + full * big_minus_min;
+    step = ((step & ge_min_mask) | (ONES & ~ge_min_mask)) & (nonzero * 0xFF);
+
+    // Never steps past b, so the lanes can't under- or overflow
+    uint32_t down_mask = (ge & nonzero) * 0xFF;
+    return (a + (step & ~down_mask)) - (step & down_mask);
+}
+
+// Applies the proportional step to all four bytes of a packed color, two
+// lanes at a time. Bit-exact with calling propStep() on each byte.
+uint32_t NeoPixelStrip::propStepPacked(
+    uint32_t start, uint32_t finish, uint8_t min_step, uint8_t max_step
+){
+    const uint32_t LANES = 0x00FF00FF, ONES = 0x00010001;
+    uint8_t big = (max_step > min_step) ? max_step : min_step;
+    uint32_t min_lanes = min_step * ONES;
+    uint32_t not_lt = (256 - min_step) * ONES;
+    uint32_t big_minus_min = big - min_step;
+
+    uint32_t even = propStepLanes(
+        start & LANES, finish & LANES, min_lanes, not_lt, big_minus_min
+    );
+    uint32_t odd = propStepLanes(
+        (start >> 8) & LANES, (finish >> 8) & LANES, min_lanes, not_lt,
+        big_minus_min
+    );
+    return even | (odd << 8);
+}
+
 // Applies the proportional step to an entire RGB color
 uint32_t NeoPixelStrip::propStepColor(
     uint32_t start, uint32_t finish, uint8_t min_step=2, uint8_t max_step=10
 ){
-    //printf("pSC Start: %d, Finish: %d\n", start, finish);
-    std::array<uint8_t, 3> unp_start = unpack(start);
-    std::array<uint8_t, 3> unp_finish = unpack(finish);
-    uint8_t start_R = unp_start[0];
-    uint8_t start_G = unp_start[1];
-    uint8_t start_B = unp_start[2];
-    uint8_t finish_R = unp_finish[0];
-    uint8_t finish_G = unp_finish[1];
-    uint8_t finish_B = unp_finish[2];
-
-    //compare the R values between colors, G, and B as well
-    uint8_t r = propStep(start_R, finish_R, min_step, max_step);
-    uint8_t g = propStep(start_G, finish_G, min_step, max_step);
-    uint8_t b = propStep(start_B, finish_B, min_step, max_step);
-
-    //Compare the start_R, finish_R, and r values for a sanity check
-    //printf("start_R: %d start_G: %d start_B: %d\n", start_R, start_G, start_B);
-    //printf("finish_R: %d finish_G: %d finish_B: %d\n", finish_R, finish_G, finish_B);
-    //printf("stepped_R: %d stepped_G: %d stepped_B: %d\n", r, g, b);
-
-    //Return uint32_t Color compatible with Adafruit Neopixel Library
-    return strip.Color(r, g, b);
+    //Return uint32_t Color compatible with Adafruit Neopixel Library, which
+    //has no white byte
+    return propStepPacked(start, finish, min_step, max_step) & 0x00FFFFFF;
+}
+
+// Steps a whole array of colors towards their finish colors in one pass. 
+// No branches per pixel, so the loop vectorizes where the target can.
+void NeoPixelStrip::propStepColors(
+    uint32_t *current, const uint32_t *finish, uint16_t count,
+    uint8_t min_step, uint8_t max_step
+){
+    for (uint16_t i=0; i<count; i++) {
+        current[i] = propStepPacked(
+            current[i], finish[i], min_step, max_step
+        ) & 0x00FFFFFF;
+    }
 }
 
 // Functions for animating effects -----------------------------
@@ -264,9 +519,7 @@ void NeoPixelStrip::fadeInBrightness(
             //printf("Fade IUint: %d\n", i);
             brightness = i ;
             //printf("Brightness: %d\n", brightness);
-            strip.setBrightnessFunctions(
-                adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-            );
+            strip.updateBrightnessFunctions();
             strip.show() ;
             delay(wait);
         }
@@ -277,9 +530,7 @@ void NeoPixelStrip::fadeInBrightness(
             //printf("Fade IUint: %d\n", i);
             brightness = i ;
             //printf("Brightness: %d\n", brightness);
-            strip.setBrightnessFunctions(
-                adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-            );
+            strip.updateBrightnessFunctions();
             strip.show() ;
             delay(wait);
         }
@@ -298,9 +549,7 @@ void NeoPixelStrip::fadeOutBrightness(uint16_t wait
         //printf("Fade IUint: %d\n", i);
         brightness = i;
         //printf("Brightness: %d\n", brightness);
-        strip.setBrightnessFunctions(
-            adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-        );
+        strip.updateBrightnessFunctions();
         strip.show() ;
         delay(wait);
     }
@@ -310,18 +559,18 @@ void NeoPixelStrip::fadeOutBrightness(uint16_t wait
 // Function specifically to fade in on time with the startup music of the 
 // GameCube
 void NeoPixelStrip::initialFadeIn() {
-    int j=brightness;
+    // on a fixed grid, so the fade ends on time however long show() takes
+    NeoPixelBeatClock fade(5625);
+    fade.start(time_us_64());
     for (int i=1; i<=160; i++) {
         //printf("Fade I: %d\n", i);
         i = uint8_t(i);
         //printf("Fade IUint: %d\n", i);
         brightness = i ;
         //printf("Brightness: %d\n", brightness);
-        strip.setBrightnessFunctions(
-            adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-        );
+        strip.updateBrightnessFunctions();
         strip.show() ;
-        sleep_us(5625);
+        fade.wait();
     }
 }
 
@@ -341,29 +590,34 @@ void NeoPixelStrip::propTransitionSingle(
     	strip.setPixelColor(pixel, next_color);
         
         current = next_color;
-    	strip.show();                          //  Update strip to match
+    	strip.showChanged();                   //  Send up to the pixel that changed
         delay(wait);                           //  Pause for a moment
     }
-    updateStateColors();
+    // Only this pixel changed, so only re-read it
+    markStateDirty(pixel < pixelOrder.size() ? pixelOrder[pixel] : pixel);
+    syncDirtyStateColors();
 }
 
 void NeoPixelStrip::propTransitionAll(uint32_t finish_color, uint16_t wait, uint8_t min_step, uint8_t max_step){
     std::vector<uint32_t> current(strip.numPixels(), 1), finish(strip.numPixels(), 1);
-    printf("checked state: #%x #%x #%x #%x #%x\n", led_power, led_1, led_2, led_3, led_4);
+    ANIM_PRINTF0(TRACE_TRANSITION_ALL, led_power, finish_color,
+        "checked state: #%x #%x #%x #%x #%x\n",
+        led_power, led_1, led_2, led_3, led_4);
     for (int pixel = 0; pixel<strip.numPixels(); pixel++) {
-        printf("got pixel color: %x\n", strip.getPixelColor(pixel));
         current[pixel] = strip.getPixelColor(pixel);
+        ANIM_PRINTF1(TRACE_PIXEL_COLOR, pixel, current[pixel],
+            "got pixel color: %x\n", current[pixel]);
         finish[pixel] = finish_color;
     }
         
     while (current != finish){
-        for (int i=0; i<strip.numPixels(); i++){
-            printf("Pixel: %d\n", pixelOrder[parseOrder(i)]);
-            printf("Current Color: %d\n", current[pixelOrder[parseOrder(i)]]);
-            uint32_t next_step = propStepColor(current[pixelOrder[parseOrder(i)]], finish_color, min_step, max_step);
-            strip.setPixelColor(pixelOrder[parseOrder(i)], next_step);
-            current[pixelOrder[parseOrder(i)]] = next_step;
-            printf("Next Color: %d\n", current[pixelOrder[parseOrder(i)]]);
+        // Every pixel steps the same way, so the order doesn't matter here
+        propStepColors(
+            current.data(), finish.data(), strip.numPixels(), min_step, 
+            max_step
+        );
+        for (int pixel=0; pixel<strip.numPixels(); pixel++){
+            strip.setPixelColor(pixel, current[pixel]);
         }
         strip.show();
         delay(wait);
@@ -382,43 +636,70 @@ void NeoPixelStrip::propTransitionBrightness(
         uint8_t next = propStep(current, finish, 2, 10);
         brightness = next;
         current = next;
-        strip.setBrightnessFunctions(
-            adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-        );
+        strip.updateBrightnessFunctions();
         strip.show();
         delay(wait);
     }
 }
 
+// Time-based versions of the transitions above. Each frame is computed from
+// the time elapsed, so they take duration_ms however far apart the colors
+// are, and a late frame doesn't make them run longer.
+void NeoPixelStrip::transitionAll(
+    uint32_t finish_color, uint32_t duration_ms, NeoPixelEasing easing,
+    uint16_t frame_ms
+){
+    TransitionAllEffect effect(*this, finish_color, duration_ms, easing, frame_ms);
+    NeoPixelScheduler().run(&effect);
+}
+
+void NeoPixelStrip::transitionSingle(
+    uint16_t pixel, uint32_t finish_color, uint32_t duration_ms,
+    NeoPixelEasing easing, uint16_t frame_ms
+){
+    if (pixel >= strip.numPixels()) {
+        return;
+    }
+    TransitionSingleEffect effect(
+        *this, pixel, finish_color, duration_ms, easing, frame_ms
+    );
+    NeoPixelScheduler().run(&effect);
+}
+
+void NeoPixelStrip::transitionBrightness(
+    uint8_t finish_value, uint32_t duration_ms, NeoPixelEasing easing,
+    uint16_t frame_ms
+){
+    TransitionBrightnessEffect effect(
+        *this, finish_value, duration_ms, easing, frame_ms
+    );
+    NeoPixelScheduler().run(&effect);
+}
+
 //handles repetitive tasks in alt_opp_fade. Alternates color assignment
 void NeoPixelStrip::altOppFadeHelper(
     uint32_t color_1, uint32_t color_2, uint16_t wait, uint8_t min_step,
     uint8_t max_step
 ){
-    uint32_t transition_1 = color_1;
-    uint32_t transition_2 = color_2;
+    //transition[0] fades towards color_2, transition[1] towards color_1
+    uint32_t transition[2] = {color_1, color_2};
+    const uint32_t target[2] = {color_2, color_1};
     //either would do as they are exact opposites
-    while (transition_2 != color_1){
+    while (transition[1] != color_1){
+        // Step both colors once per frame, not once per pixel
+        propStepColors(transition, target, 2, min_step, max_step);
         for (int i=0; i<strip.numPixels(); i++){
             //even pixel
             if (pixelOrder[parseOrder(i)] % 2 == 0){
-                uint32_t nextStep = propStepColor(
-                    transition_2, color_1, min_step, max_step
-                );
-                strip.setPixelColor(pixelOrder[parseOrder(i)], nextStep);
+                strip.setPixelColor(pixelOrder[parseOrder(i)], transition[1]);
             }
             //odd pixel
             else {
-                uint32_t nextStep = propStepColor(
-                    transition_1, color_2, min_step, max_step
-                );
-                strip.setPixelColor(pixelOrder[parseOrder(i)], nextStep);
+                strip.setPixelColor(pixelOrder[parseOrder(i)], transition[0]);
             }
         }
         delay(wait);
         strip.show();
-        transition_1 = propStepColor(transition_1, color_2, min_step, max_step);
-        transition_2 = propStepColor(transition_2, color_1, min_step, max_step);
     }
 }
 
@@ -426,15 +707,10 @@ void NeoPixelStrip::altOppFadeHelper(
 void NeoPixelStrip::altOppFade(
     uint32_t color_1, uint32_t color_2, uint8_t repetitions, uint16_t wait, uint8_t min_step, uint8_t max_step
 ){
-    for (int i=0; i<repetitions; i++){
-        if (i % 2 == 0){
-            altOppFadeHelper(color_2, color_1, wait, min_step, max_step);
-        } else {
-            altOppFadeHelper(color_1, color_2, wait, min_step, max_step);
-        }
-    }
-    updateStateColors();
-    effect_index = 3;
+    AltOppFadeEffect effect(
+        *this, color_1, color_2, repetitions, wait, min_step, max_step
+    );
+    NeoPixelScheduler().run(&effect);
 }
 
 // Fill strip pixels one after another with a color. Strip is NOT cleared
@@ -443,83 +719,28 @@ void NeoPixelStrip::altOppFade(
 // strip.Color(red, green, blue) as shown in the loop() function above),
 // and a delay time (in milliseconds) between pixels.
 void NeoPixelStrip::colorWipe(uint32_t color, int wait) {
-    for(int i=0; i<strip.numPixels(); i++) { // For each pixel in strip...
-        strip.setPixelColor(pixelOrder[parseOrder(i)], color);         //  Set pixel's color (in RAM)
-        strip.show();                          //  Update strip to match
-        delay(wait);                           //  Pause for a moment
-    }
-    updateStateColors();
+    ColorWipeEffect effect(*this, color, wait);
+    NeoPixelScheduler().run(&effect);
 }
 
 // Theater-marquee-style chasing lights. Pass in a color (32-bit value,
 // a la strip.Color(r,g,b) as mentioned above), and a delay time (in ms)
 // between frames.
 void NeoPixelStrip::theaterChase(uint32_t color, int wait) {
-    for(int a=0; a<10; a++) {  // Repeat 10 times...
-        for(int b=0; b<3; b++) { //  'b' counts from 0 to 2...
-        strip.clear();         //   Set all pixels in RAM to 0 (off)
-        // 'c' counts up from 'b' to end of strip in steps of 3...
-        for(int c=b; c<strip.numPixels(); c += 3) {
-            strip.setPixelColor(pixelOrder[parseOrder(c)], color); // Set pixel 'c' to value 'color'
-        }
-        strip.show(); // Update strip with new contents
-        delay(wait);  // Pause for a moment
-        }
-    }
-    updateStateColors();
+    TheaterChaseEffect effect(*this, color, wait);
+    NeoPixelScheduler().run(&effect);
 }
 
 // Rainbow cycle along whole strip. Pass delay time (in ms) between frames.
 void NeoPixelStrip::rainbow(int wait){
-    
-    // Hue of first pixel runs 2 complete loops through the color wheel.
-    // Color wheel has a range of 65536 but it's OK if we roll over, so
-    // just count from 0 to 2*65536. Adding 1024 to firstPixelHue each time
-    // means we'll make 2*65536/512 = 256 passes through this outer loop:
-    for(long firstPixelHue = 0; firstPixelHue < 2*65536; firstPixelHue += 512) {
-        for(int i=0; i<strip.numPixels(); i++) { // For each pixel in strip...
-        // Offset pixel hue by an amount to make one full revolution of the
-        // color wheel (range of 65536) along the length of the strip
-        // (strip.numPixels() steps):
-        int pixelHue = firstPixelHue + (i * 65536L / strip.numPixels());
-        // strip.ColorHSV() can take 1 or 3 arguments: a hue (0 to 65535) or
-        // optionally add saturation and value (brightness) (each 0 to 255).
-        // Here we're using just the single-argument hue variant. The result
-        // is passed through strip.gamma32() to provide 'truer' colors
-        // before assigning to each pixel:
-        strip.setPixelColor(pixelOrder[parseOrder(i)], strip.gamma32(strip.ColorHSV(pixelHue)));
-        }
-        strip.show(); // Update strip with new contents
-        delay(wait);  // Pause for a moment
-    }
-    updateStateColors();
-    effect_index = 1;
+    RainbowEffect effect(*this, wait);
+    NeoPixelScheduler().run(&effect);
 }
 
 // Rainbow-enhanced theater marquee. Pass delay time (in ms) between frames.
 void NeoPixelStrip::theaterChaseRainbow(int wait) {
-    int firstPixelHue = 0;     // First pixel starts at red (hue 0)
-    for(int a=0; a<30; a++) {  // Repeat 30 times...
-        for(int b=0; b<3; b++) { //  'b' counts from 0 to 2...
-        strip.clear();         //   Set all pixels in RAM to 0 (off)
-        // 'c' counts up from 'b' to end of strip in increments of 3...
-        for(int c=b; c<strip.numPixels(); c += 3) {
-            // hue of pixel 'c' is offset by an amount to make one full
-            // revolution of the color wheel (range 65536) along the length
-            // of the strip (strip.numPixels() steps):
-            int      hue   = firstPixelHue + c * 65536L / strip.numPixels();
-            uint32_t color = strip.gamma32(strip.ColorHSV(hue)); // hue -> RGB
-            strip.setPixelColor(pixelOrder[parseOrder(c)], color); // Set pixel 'c' to value 'color'
-        }
-        strip.show();                // Update strip with new contents
-        delay(wait);                 // Pause for a moment
-        firstPixelHue += 65536 / 90; // One cycle of color wheel over 90 frames
-        }
-    }
-    // fill all with color 1 afterwards to prevent only having one LED lit
-    strip.fill(effect_color_1);
-    updateStateColors();
-    effect_index = 2;
+    TheaterChaseRainbowEffect effect(*this, wait);
+    NeoPixelScheduler().run(&effect);
 }
 
 // Endpoint functions intended to be interacted with by other projects
@@ -527,98 +748,61 @@ void NeoPixelStrip::theaterChaseRainbow(int wait) {
 // Set a single pixel color. No return required as the parameters that set
 // the final values would be the ones used in the return.
 void NeoPixelStrip::htmlSinglePixel(int pixel_num, uint32_t packed_color, int wait) {
-    for (int i=0; i<strip.numPixels(); i++) {
-        if (pixelOrder[i] == pixel_num) {
-            printf("Pixel #: %d, i: %d, pixelOrder[i]: %d\n", pixel_num, i, pixelOrder[i]);
-            propTransitionSingle(
-                i,
-                strip.getPixelColor(i),
-                packed_color,
-                wait
-            );
-        }
+    if (pixel_num < 0 || pixel_num >= strip.numPixels()) {
+        return;
+    }
+    uint16_t i = parseOrder(pixel_num);
+    ANIM_PRINTF0(TRACE_SINGLE_PIXEL, pixel_num, i,
+        "Pixel #: %d, i: %d\n", pixel_num, i);
+    propTransitionSingle(
+        i,
+        strip.getPixelColor(i),
+        packed_color,
+        wait
+    );
+}
+
+// Starts a fade and returns straight away. Every running fade advances in
+// the same frame, with a single show(), so a second request doesn't wait
+// for the first one to finish.
+bool NeoPixelStrip::htmlRetargetPixel(
+    int pixel_num, uint32_t packed_color, uint32_t duration_ms
+) {
+    if (pixel_num < 0 || pixel_num >= strip.numPixels()) {
+        return false;
+    }
+    return transitions.retarget(
+        pixel_num, packed_color, duration_ms, time_us_64()
+    );
+}
+
+bool NeoPixelStrip::pollTransitions() {
+    if (!transitions.active()) {
+        return false;
     }
+    uint64_t now = time_us_64();
+    if (now < transitions.nextDue()) {
+        return true;
+    }
+    return transitions.step(now);
+}
+
+// Plays a keyframe timeline to its end. Keyframe times count from the
+// start, so a slow frame doesn't push the rest of the show back.
+void NeoPixelStrip::playTimeline(const NeoPixelTimeline &timeline) {
+    NeoPixelTimelinePlayer player(*this, timeline);
+    NeoPixelScheduler().run(&player);
+    ANIM_PRINTF0(TRACE_BEAT_OVERRUNS, player.beat().overruns(), 
+        player.beat().worstOverrun(), "Timeline overruns: %d, worst: %dus\n",
+        player.beat().overruns(), player.beat().worstOverrun());
 }
 
 // Rainbow cycle in sync with basic sixteenth-note melody, followed by two
-// flashes in sync with final two notes. 
+// flashes in sync with final two notes. The sequence is described in 
+// timelines/gamecube_startup.txt.
 void NeoPixelStrip::gameCubeStartUp(){
-    //Sixteenth-Note beat timing
-    uint64_t sixteenthNote = 129310;
-    uint64_t eighthNote = sixteenthNote * 2;
-    
-    //Fade-in lights while the GC initially boots
-    strip.fill(strip.Color(84, 107, 222));
-    initialFadeIn();
-    //Delay for the first eighth rest
-    sleep_us(eighthNote);
-    // Hue of first pixel runs 1 complete loop through the color wheel.
-    // Color wheel has a range of 65536 but it's OK if we roll over or go short,
-    // so just count from 0 to 65536. Adding 2731 to firstPixelHue each time
-    // means we'll make (65536/2731 ≈ 24) 24 passes through this outer loop:
-    for(long firstPixelHue = 0; firstPixelHue < 65536; firstPixelHue += 2731) {
-        // Notes which should be accented 
-        bool accentedNote = ((firstPixelHue == 0) || ((firstPixelHue / 2731) == 6) || 
-            ((firstPixelHue / 2731) == 14) || ((firstPixelHue / 2731) == 18));
-        for(int i=0; i<strip.numPixels(); i++) { // For each pixel in strip...
-            // Offset pixel hue by an amount to make one full revolution of the
-            // color wheel (range of 65536) along the length of the strip
-            // (strip.numPixels() steps):
-            int pixelHue = firstPixelHue + (i * 65536L / strip.numPixels());
-            // strip.ColorHSV() can take 1 or 3 arguments: a hue (0 to 65535) or
-            // optionally add saturation and value (brightness) (each 0 to 255).
-            // Here we're using just the triple-argument hue variant. The result
-            // is passed through strip.gamma32() to provide 'truer' colors
-            // before assigning to each pixel:
-            if (accentedNote) {
-                // brightness = 180;
-                // strip.setBrightnessFunctions(
-                //     adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-                // );
-                strip.setPixelColor(
-                    pixelOrder[parseOrder(i)], 
-                    strip.gamma32(strip.ColorHSV(pixelHue, 255, 210))
-                );
-            } else {
-                // brightness = 100;
-                // strip.setBrightnessFunctions(
-                //     adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-                // );
-                strip.setPixelColor(
-                    pixelOrder[parseOrder(i)], 
-                    strip.gamma32(strip.ColorHSV(pixelHue, 255, 160))
-                );
-            }
-        }
-        strip.show(); // Update strip with new contents
-        sleep_us(sixteenthNote);  // Wait for a 16th of a beat
-    }
-    // final six sixteenth notes. (really 3 eighth notes)
-    // first at 180
-    // brightness = 180;
-    // strip.setBrightnessFunctions(
-    //     adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-    // );
-    strip.fill(strip.Color(75, 0, 130)); // bright indigo
-    strip.show();
-    sleep_us(eighthNote);
-
-    // rest at 0
-    strip.fill();
-    strip.show();
-    sleep_us(eighthNote);
-
-    // second at 230
-    // brightness = 230;
-    // strip.setBrightnessFunctions(
-    //     adjustBrightness, adjustBrightness, adjustBrightness, adjustBrightness
-    // );
-    strip.fill(strip.ColorHSV(strip.Color(0, 0, 0), 0, 240)); // brighter white
-    strip.show();
-    fadeInBrightness(100, 20);
-    propTransitionAll(strip.Color(84, 107, 222), 20);
+    playTimeline(gamecube_startup);
     effect_index=0;
-    //updateStateColors();
 }
 
 // demo_loop() function -- Demonstration of basic usage
@@ -2,13 +2,41 @@
 #define PICO_NEOPIXEL_ANIMATIONS_H_INCLUDED
 /* ^^ these are the include guards */
 #include "Adafruit_NeoPixel.hpp"
+#include "pico_neopixel_effects.h"
+#include "pico_neopixel_timeline.h"
+#include "pico_neopixel_arena.h"
 #include <array>
 #include <string>
 #include <vector>
 
 
+/* Static storage for a NeoPixelStrip of Length pixels: the strip's buffers
+   and room for its pixel order and color state tables. A strip built on
+   one makes no heap allocations. */
+template <uint16_t Length>
+struct NeoPixelStripStorage {
+    NeoPixelStaticBuffers<Length> strip;
+    // pixelOrder, electricalOrder, pixelColors and transitionStartColors,
+    // plus alignment
+    alignas(4) uint8_t tables[
+        Length * (sizeof(int) + sizeof(uint16_t) + 2 * sizeof(uint32_t)) + 8
+    ];
+};
+
 /* Prototypes for the class and functions */
 class NeoPixelStrip {
+    // frame-at-a-time versions of the animations below
+    friend class ColorWipeEffect;
+    friend class TheaterChaseEffect;
+    friend class RainbowEffect;
+    friend class TheaterChaseRainbowEffect;
+    friend class AltOppFadeEffect;
+    friend class TransitionAllEffect;
+    friend class TransitionSingleEffect;
+    friend class TransitionBrightnessEffect;
+    friend class PixelTransitionPool;
+    friend class NeoPixelTimelinePlayer;
+
     private:
     /* only needed if the = delete trick below doesn't work.
         NeoPixelStrip(const NeoPixelStrip& );
@@ -16,9 +44,29 @@ class NeoPixelStrip {
     */
         Adafruit_NeoPixel strip;
         std::string pixelOrderString;
-        std::vector<int> pixelOrder;
+        //Storage for the tables below; empty unless built on a 
+        //NeoPixelStripStorage, then they come from the heap
+        NeoPixelArena tableArena;
+        std::vector<int, NeoPixelArenaAllocator<int>> pixelOrder{
+            NeoPixelArenaAllocator<int>(&tableArena)
+        };
+        //Inverse of pixelOrder: electrical index of each visual position
+        std::vector<uint16_t, NeoPixelArenaAllocator<uint16_t>> electricalOrder{
+            NeoPixelArenaAllocator<uint16_t>(&tableArena)
+        };
         //Retain the current color of each LED
-        std::vector<uint32_t> pixelColors;
+        std::vector<uint32_t, NeoPixelArenaAllocator<uint32_t>> pixelColors{
+            NeoPixelArenaAllocator<uint32_t>(&tableArena)
+        };
+        //Color of each pixel (electrical order) when transitionAll() began;
+        //sized on first use
+        std::vector<uint32_t, NeoPixelArenaAllocator<uint32_t>> transitionStartColors{
+            NeoPixelArenaAllocator<uint32_t>(&tableArena)
+        };
+        //Visual range [first, end) of pixelColors that is out of date
+        uint16_t stateDirtyFirst = 0, stateDirtyEnd = 0;
+        //Single pixel fades started by htmlRetargetPixel()
+        PixelTransitionPool transitions{*this};
         //Make externalizing the colors simpler
         uint32_t led_power, led_1, led_2, led_3, led_4;
         
@@ -46,6 +94,22 @@ class NeoPixelStrip {
             uint8_t brightness=160
         );
 
+        /* Builds the strip on static storage instead of the heap, e.g.
+           static NeoPixelStripStorage<300> storage;
+           NeoPixelStrip npStrip(pin, storage); */
+        template <uint16_t Length>
+        NeoPixelStrip(
+            uint16_t pin,
+            NeoPixelStripStorage<Length> &storage,
+            std::string pixelOrderString="default",
+            uint8_t brightness=160
+        ):
+            strip(pin, NEO_GRB + NEO_KHZ800, storage.strip),
+            tableArena(storage.tables, sizeof(storage.tables))
+        {
+            setup(pixelOrderString);
+        }
+
         static uint8_t brightness; //Max 255
 
         /* Return type for entire state */
@@ -80,6 +144,70 @@ class NeoPixelStrip {
             ei_ref, ec1_ref, ec2_ref, as_ref, ar_ref, ab_ref, 
             pwr_ref, p1_ref, p2_ref, p3_ref, p4_ref
         };
+
+        /* A view straight onto the strip's pixel buffer, indexed in visual
+           order. Writes go to the buffer in wire format with no per-pixel
+           calls; the brightness is applied when the strip is shown. Every
+           index is bounds checked, out of range pixels are skipped. Writes
+           are marked dirty for showChanged(). Get one from frame(); it 
+           stays valid as long as the strip does. */
+        class FrameView {
+            public:
+                /* Number of pixels in the view */
+                uint16_t size() const { return count; }
+
+                /* Sets the pixel at visual position i to a packed color */
+                void set(uint16_t i, uint32_t color);
+
+                /* Returns the packed color of the pixel at visual position 
+                   i, 0 if out of range */
+                uint32_t get(uint16_t i) const;
+
+                /* Sets n pixels starting at visual position first to color */
+                void fill_range(uint16_t first, uint16_t n, uint32_t color);
+
+                /* Copies n packed colors into the pixels starting at visual 
+                   position first */
+                void copy_from(const uint32_t *colors, uint16_t n, uint16_t first = 0);
+
+                /* Moves each of n pixels starting at visual position first 
+                   amount/256 of the way towards the matching packed color */
+                void blend_from(
+                    const uint32_t *colors, uint16_t n, uint8_t amount,
+                    uint16_t first = 0
+                );
+
+                /* Moves every pixel by n visual positions, towards the end 
+                   of the strip for positive n. Vacated pixels get fill */
+                void shift(int n, uint32_t fill = 0);
+
+            private:
+                friend class NeoPixelStrip;
+                FrameView(
+                    Adafruit_NeoPixel &strip, const uint16_t *order,
+                    uint16_t count
+                );
+
+                /* First byte of the pixel at visual position i */
+                uint8_t *at(uint16_t i) const { return pixels + order[i] * bpp; }
+
+                /* at(), for a pixel about to be written */
+                uint8_t *touch(uint16_t i) const {
+                    strip->markDirty(order[i] + 1);
+                    return at(i);
+                }
+                void store(uint8_t *p, uint32_t color) const;
+                uint32_t load(const uint8_t *p) const;
+
+                Adafruit_NeoPixel *strip;
+                uint8_t *pixels;
+                const uint16_t *order;
+                uint16_t count;
+                uint8_t bpp, rOffset, gOffset, bOffset, wOffset;
+        };
+
+        /* Returns a FrameView of the strip */
+        FrameView frame();
         
         /* Delay for (ms) milliseconds */
         void delay(uint32_t ms);
@@ -92,7 +220,8 @@ class NeoPixelStrip {
         uint32_t packColor(uint8_t r_comp, uint8_t g_comp, uint8_t b_comp);
 
         /* Returns the index of a specific NeoPixel in the electrical order, 
-           based on it's visual position.
+           based on it's visual position. A single lookup in the table built
+           by interpretPixelOrder().
         */
         uint16_t parseOrder(uint16_t value);
 
@@ -115,11 +244,26 @@ class NeoPixelStrip {
         /* Updates the colors contained in the state tuple */
         void updateStateColors();
 
+        /* Records that the pixel at a visual position changed since the 
+           last state sync */
+        void markStateDirty(uint16_t visual);
+
+        /* Updates only the state colors marked by markStateDirty() */
+        void syncDirtyStateColors();
+
+        /* Updates the state color of the pixel at a visual position, 
+           without syncing the state variables */
+        void syncStateColor(uint16_t visual);
+
+        /* Shared part of the constructors: pixel order, colors and 
+           brightness */
+        void setup(const std::string &pixelOrderString);
+
         /* Interprets the initial pixelOrderString string into an appropriate 
            length Array by breaking the string on each space, then returns 
            the visual index of the pixel, based on its actual electrical 
-           order */
-        void interpretPixelOrder(std::string str);
+           order. Also builds the inverse table used by parseOrder() */
+        void interpretPixelOrder(const std::string &str);
 
         /* Takes two uint32_t colors as arguments and sets the 2 colors displayed
            in the browser, then alternates the colors onto every pixel */
@@ -146,6 +290,25 @@ class NeoPixelStrip {
             uint8_t max_step
         );
 
+        /* Applies the propStep function to all four bytes of a packed color 
+           at once, each byte stepping independently */
+        static uint32_t propStepPacked(
+            uint32_t start,
+            uint32_t finish,
+            uint8_t min_step,
+            uint8_t max_step
+        );
+
+        /* Steps count RGB colors one propStepColor step towards their 
+           finish colors, in place */
+        static void propStepColors(
+            uint32_t *current,
+            const uint32_t *finish,
+            uint16_t count,
+            uint8_t min_step,
+            uint8_t max_step
+        );
+
         /* Function to fade from the current brightness up to the given value */
         void fadeInBrightness(uint8_t brightnessLevel, uint16_t wait = 50);
 
@@ -182,6 +345,33 @@ class NeoPixelStrip {
             uint8_t max_step = 10
         );
 
+        /* Transitions all pixels to finish_color in duration_ms, whatever 
+           the color distance. A frame is shown every frame_ms */
+        void transitionAll(
+            uint32_t finish_color,
+            uint32_t duration_ms,
+            NeoPixelEasing easing = NeoPixelEasing::Linear,
+            uint16_t frame_ms = 20
+        );
+
+        /* Transitions the pixel at a visual position to finish_color in 
+           duration_ms */
+        void transitionSingle(
+            uint16_t pixel,
+            uint32_t finish_color,
+            uint32_t duration_ms,
+            NeoPixelEasing easing = NeoPixelEasing::Linear,
+            uint16_t frame_ms = 20
+        );
+
+        /* Transitions the brightness to finish_value in duration_ms */
+        void transitionBrightness(
+            uint8_t finish_value,
+            uint32_t duration_ms,
+            NeoPixelEasing easing = NeoPixelEasing::Linear,
+            uint16_t frame_ms = 20
+        );
+
         /* handles repetitive tasks in alt_opp_fade. Alternates color 
            assignment */
         void altOppFadeHelper(
@@ -221,6 +411,21 @@ class NeoPixelStrip {
            Transitions a single pixel to a new color */
         void htmlSinglePixel(int pixel_num, uint32_t packed_color, int wait);
 
+        /* Non-blocking version of htmlSinglePixel(): starts fading the 
+           pixel to packed_color over duration_ms and returns. Fades of 
+           other pixels keep running; call pollTransitions() from the main 
+           loop to advance them. Returns false if pixel_num is out of range */
+        bool htmlRetargetPixel(
+            int pixel_num, uint32_t packed_color, uint32_t duration_ms
+        );
+
+        /* Renders the next frame of the htmlRetargetPixel() fades if it is 
+           due. Returns true while any of them is still running */
+        bool pollTransitions();
+
+        /* Plays a keyframe timeline (see pico_neopixel_timeline.h) */
+        void playTimeline(const NeoPixelTimeline &timeline);
+
         /* Startup animation synced with the GameCube startup song */
         void gameCubeStartUp();
 
@@ -0,0 +1,78 @@
+#ifndef PICO_NEOPIXEL_ARENA_H_INCLUDED
+#define PICO_NEOPIXEL_ARENA_H_INCLUDED
+/* ^^ these are the include guards */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Hands out memory from a caller-provided block, front to back. Memory 
+   given back is not reused, so it suits tables that are sized once, like
+   NeoPixelStrip's pixel order and color state. */
+class NeoPixelArena {
+    public:
+        NeoPixelArena(void *block = nullptr, size_t size = 0):
+            base((uint8_t *)block), size(block ? size : 0) {}
+
+        /* Returns bytes of memory aligned to align, or nullptr once the 
+           block is used up */
+        void *allocate(size_t bytes, size_t align) {
+            size_t start = (used + align - 1) & ~(align - 1);
+            if (start > size || bytes > size - start) {
+                return nullptr;
+            }
+            used = start + bytes;
+            return base + start;
+        }
+
+        /* True if p came from this arena */
+        bool owns(const void *p) const {
+            return p >= base && p < base + size;
+        }
+
+        /* Bytes handed out so far, alignment included */
+        size_t bytesUsed() const { return used; }
+
+    private:
+        uint8_t *base;
+        size_t size;
+        size_t used = 0;
+};
+
+/* Standard allocator on top of a NeoPixelArena, for std::vector and the 
+   like. Without an arena, or once it's used up, it falls back to the 
+   heap. */
+template <class T>
+struct NeoPixelArenaAllocator {
+    typedef T value_type;
+
+    NeoPixelArena *arena;
+
+    NeoPixelArenaAllocator(NeoPixelArena *arena = nullptr): arena(arena) {}
+
+    template <class U>
+    NeoPixelArenaAllocator(const NeoPixelArenaAllocator<U> &other):
+        arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        void *p = arena ? arena->allocate(n * sizeof(T), alignof(T)) : nullptr;
+        return (T *)(p ? p : malloc(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t) {
+        if (!arena || !arena->owns(p)) {
+            free(p);
+        }
+    }
+
+    template <class U>
+    bool operator==(const NeoPixelArenaAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+
+    template <class U>
+    bool operator!=(const NeoPixelArenaAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+};
+
+#endif
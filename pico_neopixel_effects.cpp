@@ -0,0 +1,576 @@
+#include "pico/stdlib.h"
+#include "pico_neopixel_effects.h"
+#include "pico_neopixel_animations.h"
+#include "Adafruit_NeoPixel.hpp"
+#include "NeoPixelStats.hpp"
+#include "pico_neopixel_hue.h"
+
+// Scheduler ----------------------------------------------------
+
+#ifdef NEOPIXEL_STATS
+// Steps effect and records how long the frame took to render and how well
+// it kept to the schedule the effect asked for
+static bool timedStep(
+    NeoPixelEffect *effect, uint64_t now_us, uint64_t &last_step_us
+) {
+    uint64_t due = effect->nextDue();
+    uint64_t shown = NeoPixelStats::total(NEOPIXEL_STAT_SHOW);
+    bool more = effect->step(now_us);
+    uint64_t spent = time_us_64() - now_us;
+    shown = NeoPixelStats::total(NEOPIXEL_STAT_SHOW) - shown;
+    // show() is recorded on its own; another core's shows may overlap
+    NeoPixelStats::record(
+        NEOPIXEL_STAT_RENDER, spent > shown ? spent - shown : 0
+    );
+    NeoPixelStats::record(
+        NEOPIXEL_STAT_LATENESS, now_us > due ? now_us - due : 0
+    );
+    if (last_step_us) {
+        NeoPixelStats::record(NEOPIXEL_STAT_PERIOD, now_us - last_step_us);
+    }
+    if (more) {
+        NeoPixelStats::record(
+            NEOPIXEL_STAT_REQUESTED, effect->nextDue() - now_us
+        );
+    }
+    last_step_us = more ? now_us : 0;
+    return more;
+}
+#define TIMED_STEP(effect, now_us, last_step_us) timedStep(effect, now_us, last_step_us)
+#else
+#define TIMED_STEP(effect, now_us, last_step_us) (effect)->step(now_us)
+#endif
+
+void NeoPixelScheduler::start(NeoPixelEffect *effect, uint64_t now_us) {
+    current = effect;
+    if (current) {
+        current->begin(now_us);
+    }
+}
+
+void NeoPixelScheduler::stop() {
+    current = nullptr;
+}
+
+bool NeoPixelScheduler::poll(uint64_t now_us) {
+    if (!current) {
+        return false;
+    }
+    if (now_us < current->nextDue()) {
+        return true;
+    }
+    if (!TIMED_STEP(current, now_us, last_step_us)) {
+        current = nullptr;
+    }
+    return current != nullptr;
+}
+
+void NeoPixelScheduler::idle() {
+    if (!current) {
+        return;
+    }
+    // Sleeps the core with wfe, so an interrupt (Wi-Fi, USB, ...) still
+    // gets the main loop going again before the frame is due
+    NEOPIXEL_STATS_START(start);
+    best_effort_wfe_or_timeout(from_us_since_boot(current->nextDue()));
+    NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_SLEEP, start);
+}
+
+void NeoPixelScheduler::run(NeoPixelEffect *effect) {
+#ifdef NEOPIXEL_STATS
+    uint64_t last_step_us = 0;
+#endif
+    effect->begin(time_us_64());
+    while (TIMED_STEP(effect, time_us_64(), last_step_us)) {
+        NEOPIXEL_STATS_START(start);
+        sleep_until(from_us_since_boot(effect->nextDue()));
+        NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_SLEEP, start);
+    }
+}
+
+// Beat grid ----------------------------------------------------
+
+NeoPixelBeatClock::NeoPixelBeatClock(uint32_t tick_us):
+    num(tick_us), den(1) {}
+
+NeoPixelBeatClock::NeoPixelBeatClock(uint16_t bpm, uint8_t ticks_per_beat):
+    num(60000000ULL),
+    den((bpm ? bpm : 1) * (uint32_t)(ticks_per_beat ? ticks_per_beat : 1)) {}
+
+void NeoPixelBeatClock::start(uint64_t origin) {
+    origin_us = origin;
+    cursor = 0;
+    overrun_count = overrun_max = 0;
+}
+
+uint64_t NeoPixelBeatClock::deadline(uint32_t tick) const {
+    // one multiply and divide from the origin, so rounding never adds up
+    return origin_us + tick * num / den;
+}
+
+void NeoPixelBeatClock::noteOverrun(uint64_t lateness) {
+    if (lateness == 0) {
+        return;
+    }
+    overrun_count++;
+    if (lateness > overrun_max) {
+        overrun_max = lateness > UINT32_MAX ? UINT32_MAX : lateness;
+    }
+}
+
+uint32_t NeoPixelBeatClock::waitUntil(uint32_t tick) {
+    cursor = tick;
+    uint64_t due = deadline(tick);
+    uint64_t now = time_us_64();
+    NEOPIXEL_STATS_RECORD(NEOPIXEL_STAT_LATENESS, now > due ? now - due : 0);
+    if (now > due) {
+        noteOverrun(now - due);
+        return now - due > UINT32_MAX ? UINT32_MAX : now - due;
+    }
+    noteOverrun(0);
+    NEOPIXEL_STATS_START(start);
+    sleep_until(from_us_since_boot(due));
+    NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_SLEEP, start);
+    return 0;
+}
+
+void BeatEffect::startGrid(uint64_t now_us) {
+    clock.start(now_us);
+    late = false;
+    next_due = now_us;
+}
+
+void BeatEffect::beatAt(uint64_t now_us, uint32_t tick) {
+    if (tick != clock.cursor) {
+        clock.cursor = tick;
+        late = false;
+    }
+    next_due = clock.deadline(tick);
+    if (!late && now_us > next_due) {
+        clock.noteOverrun(now_us - next_due);
+        late = true;
+    }
+}
+
+// Effects ------------------------------------------------------
+// Each step() renders what one pass of the original loop body did, then
+// asks to run again wait ms later. The step after the last frame only does
+// the bookkeeping the blocking version did after its loop.
+
+ColorWipeEffect::ColorWipeEffect(NeoPixelStrip &np, uint32_t color, int wait):
+    np(np), color(color), wait(wait) {}
+
+void ColorWipeEffect::begin(uint64_t now_us) {
+    frame = 0;
+    next_due = now_us;
+}
+
+bool ColorWipeEffect::step(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    if (frame >= strip.numPixels()) {
+        np.updateStateColors();
+        return false;
+    }
+    strip.setPixelColor(np.pixelOrder[np.parseOrder(frame)], color);
+    // only the pixels up to the one just set need sending
+    strip.showChanged();
+    frame++;
+    next_due = now_us + wait * 1000ULL;
+    return true;
+}
+
+TheaterChaseEffect::TheaterChaseEffect(
+    NeoPixelStrip &np, uint32_t color, int wait
+): np(np), color(color), wait(wait) {}
+
+void TheaterChaseEffect::begin(uint64_t now_us) {
+    frame = 0;
+    next_due = now_us;
+}
+
+bool TheaterChaseEffect::step(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    if (frame >= 10 * 3) { // Repeat 10 times, 3 frames each
+        np.updateStateColors();
+        return false;
+    }
+    strip.clear();
+    // 'c' counts up from 'b' to end of strip in steps of 3...
+    for(int c=frame % 3; c<strip.numPixels(); c += 3) {
+        strip.setPixelColor(np.pixelOrder[np.parseOrder(c)], color);
+    }
+    strip.show();
+    frame++;
+    next_due = now_us + wait * 1000ULL;
+    return true;
+}
+
+RainbowEffect::RainbowEffect(NeoPixelStrip &np, int wait):
+    np(np), wait(wait) {}
+
+void RainbowEffect::begin(uint64_t now_us) {
+    firstPixelHue = 0;
+    next_due = now_us;
+}
+
+bool RainbowEffect::step(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    // Hue of first pixel runs 2 complete loops through the color wheel,
+    // 512 at a time, so 256 frames in all
+    if (firstPixelHue >= 2*65536) {
+        np.updateStateColors();
+        np.effect_index = 1;
+        return false;
+    }
+    // One full turn of the (gamma corrected) color wheel along the strip
+    NeoPixelHuePhase hue(firstPixelHue, 1, strip.numPixels());
+    for(int i=0; i<strip.numPixels(); i++) {
+        strip.setPixelColor(np.pixelOrder[np.parseOrder(i)], hue.color());
+        hue.advance();
+    }
+    strip.show();
+    firstPixelHue += 512;
+    next_due = now_us + wait * 1000ULL;
+    return true;
+}
+
+TheaterChaseRainbowEffect::TheaterChaseRainbowEffect(
+    NeoPixelStrip &np, int wait
+): np(np), wait(wait) {}
+
+void TheaterChaseRainbowEffect::begin(uint64_t now_us) {
+    frame = 0;
+    firstPixelHue = 0;     // First pixel starts at red (hue 0)
+    next_due = now_us;
+}
+
+bool TheaterChaseRainbowEffect::step(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    if (frame >= 30 * 3) { // Repeat 30 times, 3 frames each
+        // fill all with color 1 afterwards to prevent only having one LED lit
+        strip.fill(np.effect_color_1);
+        np.updateStateColors();
+        np.effect_index = 2;
+        return false;
+    }
+    strip.clear();
+    // hue of pixel c is firstPixelHue + c/numPixels of a turn
+    int first = frame % 3;
+    NeoPixelHuePhase hue(
+        firstPixelHue + first * 65536L / strip.numPixels(), 3, strip.numPixels()
+    );
+    for(int c=first; c<strip.numPixels(); c += 3) {
+        strip.setPixelColor(np.pixelOrder[np.parseOrder(c)], hue.color());
+        hue.advance();
+    }
+    strip.show();
+    firstPixelHue += 65536 / 90; // One cycle of color wheel over 90 frames
+    frame++;
+    next_due = now_us + wait * 1000ULL;
+    return true;
+}
+
+AltOppFadeEffect::AltOppFadeEffect(
+    NeoPixelStrip &np, uint32_t color_1, uint32_t color_2,
+    uint8_t repetitions, uint16_t wait, uint8_t min_step, uint8_t max_step
+):
+    np(np), color_1(color_1), color_2(color_2), repetitions(repetitions),
+    wait(wait), min_step(min_step), max_step(max_step) {}
+
+void AltOppFadeEffect::beginRepetition() {
+    // Even repetitions fade from color 2 towards color 1, odd ones back
+    from = (rep % 2 == 0) ? color_2 : color_1;
+    to = (rep % 2 == 0) ? color_1 : color_2;
+    transition[0] = from;
+    transition[1] = to;
+}
+
+void AltOppFadeEffect::begin(uint64_t now_us) {
+    rep = 0;
+    beginRepetition();
+    next_due = now_us;
+}
+
+bool AltOppFadeEffect::step(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    //either would do as they are exact opposites
+    while (rep < repetitions && transition[1] == from) {
+        rep++;
+        if (rep < repetitions) {
+            beginRepetition();
+        }
+    }
+    if (rep >= repetitions) {
+        np.updateStateColors();
+        np.effect_index = 3;
+        return false;
+    }
+    // Step both colors once per frame, not once per pixel
+    const uint32_t target[2] = {to, from};
+    np.propStepColors(transition, target, 2, min_step, max_step);
+    for (int i=0; i<strip.numPixels(); i++){
+        uint16_t pixel = np.pixelOrder[np.parseOrder(i)];
+        strip.setPixelColor(pixel, (pixel % 2 == 0) ? transition[1] : transition[0]);
+    }
+    strip.show();
+    next_due = now_us + wait * 1000ULL;
+    return true;
+}
+
+// Timed transitions --------------------------------------------
+// Progress is 16.16 fixed point: 0 is the start, 65536 the finish.
+
+uint32_t easeProgress(NeoPixelEasing easing, uint32_t t) {
+    const uint64_t one = 65536;
+    if (t >= one) {
+        return one;
+    }
+    switch (easing) {
+        case NeoPixelEasing::EaseIn:
+            return (uint64_t)t * t >> 16;
+        case NeoPixelEasing::EaseOut: {
+            uint64_t r = one - t;
+            return one - (r * r >> 16);
+        }
+        case NeoPixelEasing::EaseInOut:
+            if (t < one / 2) {
+                return (uint64_t)t * t >> 15;               // 2t^2
+            } else {
+                uint64_t r = one - t;
+                return one - (r * r >> 15);                 // 1-2(1-t)^2
+            }
+        case NeoPixelEasing::Cubic:
+            if (t < one / 2) {
+                return (uint64_t)t * t * t >> 30;           // 4t^3
+            } else {
+                uint64_t r = one - t;
+                return one - (r * r * r >> 30);             // 1-4(1-t)^3
+            }
+        case NeoPixelEasing::Linear:
+        default:
+            return t;
+    }
+}
+
+uint32_t lerpColor(uint32_t from, uint32_t to, uint32_t progress) {
+    if (progress >= 65536) {
+        return to;
+    }
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        int32_t a = (from >> shift) & 0xFF;
+        int32_t b = (to >> shift) & 0xFF;
+        // |b-a| < 256 and progress < 2^16, so this can't overflow
+        int32_t c = a + (((b - a) * (int32_t)progress) >> 16);
+        out |= (uint32_t)c << shift;
+    }
+    return out;
+}
+
+TimedTransition::TimedTransition(
+    uint32_t duration_ms, NeoPixelEasing easing, uint16_t frame_ms
+):
+    duration_us(duration_ms * 1000ULL), easing(easing),
+    frame_us(frame_ms ? frame_ms * 1000UL : 1000UL) {}
+
+void TimedTransition::startClock(uint64_t now_us) {
+    start_us = now_us;
+    next_due = now_us;
+}
+
+uint32_t TimedTransition::progressAt(uint64_t now_us) const {
+    uint64_t elapsed = now_us - start_us;
+    if (elapsed >= duration_us) {
+        return 65536;
+    }
+    return easeProgress(easing, (uint32_t)((elapsed << 16) / duration_us));
+}
+
+void TimedTransition::scheduleNext(uint64_t now_us) {
+    uint64_t end_us = start_us + duration_us;
+    next_due = now_us + frame_us;
+    if (next_due > end_us && now_us < end_us) {
+        next_due = end_us;
+    }
+}
+
+TransitionAllEffect::TransitionAllEffect(
+    NeoPixelStrip &np, uint32_t finish_color, uint32_t duration_ms,
+    NeoPixelEasing easing, uint16_t frame_ms
+):
+    TimedTransition(duration_ms, easing, frame_ms), np(np),
+    finish_color(finish_color) {}
+
+void TransitionAllEffect::begin(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    // kept in the strip's tables, so a static strip needs no heap here
+    std::vector<uint32_t, NeoPixelArenaAllocator<uint32_t>> &start_colors =
+        np.transitionStartColors;
+    start_colors.resize(strip.numPixels());
+    for (int pixel = 0; pixel < strip.numPixels(); pixel++) {
+        start_colors[pixel] = strip.getPixelColor(pixel);
+    }
+    startClock(now_us);
+}
+
+bool TransitionAllEffect::step(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    uint32_t progress = progressAt(now_us);
+    for (int pixel = 0; pixel < strip.numPixels(); pixel++) {
+        strip.setPixelColor(
+            pixel, lerpColor(np.transitionStartColors[pixel], finish_color, progress)
+        );
+    }
+    strip.show();
+    if (progress >= 65536) {
+        np.updateStateColors();
+        return false;
+    }
+    scheduleNext(now_us);
+    return true;
+}
+
+TransitionSingleEffect::TransitionSingleEffect(
+    NeoPixelStrip &np, uint16_t pixel, uint32_t finish_color,
+    uint32_t duration_ms, NeoPixelEasing easing, uint16_t frame_ms
+):
+    TimedTransition(duration_ms, easing, frame_ms), np(np), pixel(pixel),
+    finish_color(finish_color) {}
+
+void TransitionSingleEffect::begin(uint64_t now_us) {
+    start_color = np.strip.getPixelColor(np.parseOrder(pixel));
+    startClock(now_us);
+}
+
+bool TransitionSingleEffect::step(uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    uint32_t progress = progressAt(now_us);
+    strip.setPixelColor(
+        np.parseOrder(pixel), lerpColor(start_color, finish_color, progress)
+    );
+    strip.showChanged();
+    if (progress >= 65536) {
+        np.markStateDirty(pixel);
+        np.syncDirtyStateColors();
+        return false;
+    }
+    scheduleNext(now_us);
+    return true;
+}
+
+TransitionBrightnessEffect::TransitionBrightnessEffect(
+    NeoPixelStrip &np, uint8_t finish_value, uint32_t duration_ms,
+    NeoPixelEasing easing, uint16_t frame_ms
+):
+    TimedTransition(duration_ms, easing, frame_ms), np(np),
+    finish_value(finish_value) {}
+
+void TransitionBrightnessEffect::begin(uint64_t now_us) {
+    start_value = NeoPixelStrip::brightness;
+    startClock(now_us);
+}
+
+bool TransitionBrightnessEffect::step(uint64_t now_us) {
+    uint32_t progress = progressAt(now_us);
+    int32_t a = start_value, b = finish_value;
+    NeoPixelStrip::brightness = a + (((b - a) * (int32_t)progress) >> 16);
+    if (progress >= 65536) {
+        NeoPixelStrip::brightness = finish_value;
+    }
+    // the table picks up the new brightness, the pixels keep their colors
+    np.strip.updateBrightnessFunctions();
+    np.strip.show();
+    if (progress >= 65536) {
+        return false;
+    }
+    scheduleNext(now_us);
+    return true;
+}
+
+// Transition pool ----------------------------------------------
+
+PixelTransitionPool::PixelTransitionPool(NeoPixelStrip &np, uint16_t frame_ms):
+    np(np), frame_us(frame_ms ? frame_ms * 1000UL : 1000UL) {}
+
+void PixelTransitionPool::begin(uint64_t now_us) {
+    next_due = now_us;
+}
+
+bool PixelTransitionPool::render(Slot &slot, uint64_t now_us) {
+    uint64_t elapsed = now_us - slot.start_us;
+    uint32_t progress = 65536;
+    if (elapsed < slot.duration_us) {
+        progress = easeProgress(
+            slot.easing, (uint32_t)((elapsed << 16) / slot.duration_us)
+        );
+    }
+    np.strip.setPixelColor(
+        np.parseOrder(slot.pixel), lerpColor(slot.from, slot.to, progress)
+    );
+    np.syncStateColor(slot.pixel);
+    return progress < 65536;
+}
+
+bool PixelTransitionPool::step(uint64_t now_us) {
+    bool changed = false;
+    for (Slot &slot : slots) {
+        if (slot.active) {
+            slot.active = render(slot, now_us);
+            changed = true;
+        }
+    }
+    if (changed) {
+        // one show for every pixel that moved this frame, up to the 
+        // furthest of them
+        np.strip.showChanged();
+        np.syncStateWithVector();
+    }
+    next_due = now_us + frame_us;
+    return active() > 0;
+}
+
+bool PixelTransitionPool::retarget(
+    uint16_t pixel, uint32_t finish_color, uint32_t duration_ms,
+    uint64_t now_us, NeoPixelEasing easing
+){
+    if (pixel >= np.strip.numPixels()) {
+        return false;
+    }
+    Slot *use = nullptr, *oldest = nullptr;
+    for (Slot &slot : slots) {
+        if (slot.active && slot.pixel == pixel) {
+            use = &slot;
+            break;
+        }
+        if (!slot.active && !use) {
+            use = &slot;
+        }
+        if (slot.active && (!oldest || slot.start_us < oldest->start_us)) {
+            oldest = &slot;
+        }
+    }
+    if (!use) {
+        // every slot busy with another pixel: jump the oldest to its end
+        oldest->start_us = now_us - oldest->duration_us;
+        render(*oldest, now_us);
+        use = oldest;
+    }
+    use->active = true;
+    use->pixel = pixel;
+    use->easing = easing;
+    use->from = np.strip.getPixelColor(np.parseOrder(pixel));
+    use->to = finish_color;
+    use->start_us = now_us;
+    use->duration_us = duration_ms * 1000ULL;
+    // show the first change on the next poll rather than a frame later
+    next_due = now_us;
+    return true;
+}
+
+uint16_t PixelTransitionPool::active() const {
+    uint16_t count = 0;
+    for (const Slot &slot : slots) {
+        count += slot.active;
+    }
+    return count;
+}
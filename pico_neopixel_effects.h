@@ -0,0 +1,372 @@
+#ifndef PICO_NEOPIXEL_EFFECTS_H_INCLUDED
+#define PICO_NEOPIXEL_EFFECTS_H_INCLUDED
+/* ^^ these are the include guards */
+#include "pico/stdlib.h"
+#include <stdint.h>
+
+class NeoPixelStrip;
+
+#ifndef NEOPIXEL_TRANSITION_SLOTS
+#define NEOPIXEL_TRANSITION_SLOTS 16 // pixels that can fade at the same time
+#endif
+
+/* Base class for an effect that renders one frame per step() call instead
+   of looping with delay() in between. The scheduler below decides when
+   step() runs, so the main loop stays free to service other work. */
+class NeoPixelEffect {
+    public:
+        virtual ~NeoPixelEffect() {}
+
+        /* Resets the effect to its first frame */
+        virtual void begin(uint64_t now_us) = 0;
+
+        /* Renders and shows one frame, then sets nextDue(). Returns false
+           once the effect has finished */
+        virtual bool step(uint64_t now_us) = 0;
+
+        /* Time (us since boot) at which step() wants to run next */
+        uint64_t nextDue() const { return next_due; }
+
+    protected:
+        uint64_t next_due = 0;
+};
+
+/* Runs one effect at a time. Call poll() from the main loop; starting
+   another effect preempts the running one between two frames. */
+class NeoPixelScheduler {
+    public:
+        /* Makes effect the running effect, dropping the previous one */
+        void start(NeoPixelEffect *effect, uint64_t now_us);
+
+        /* Preempts the running effect */
+        void stop();
+
+        /* True while an effect is running */
+        bool running() const { return current != nullptr; }
+
+        /* Steps the running effect if its frame is due. Returns true while
+           an effect is still running */
+        bool poll(uint64_t now_us);
+
+        /* Sleeps until the next frame is due or an event (e.g. an
+           interrupt) wakes the core, whichever comes first */
+        void idle();
+
+        /* Runs effect to completion. Used by the blocking NeoPixelStrip
+           methods */
+        void run(NeoPixelEffect *effect);
+
+    private:
+        NeoPixelEffect *current = nullptr;
+#ifdef NEOPIXEL_STATS
+        //when the previous frame started, for the achieved period
+        uint64_t last_step_us = 0;
+#endif
+};
+
+/* A grid of ticks at fixed absolute times, e.g. the sixteenth notes of a
+   tune. Each deadline is computed from tick 0, never by adding up sleeps, 
+   so time spent rendering and showing doesn't make later ticks drift. A 
+   tick that is already past when waited for counts as an overrun. */
+class NeoPixelBeatClock {
+    public:
+        /* One tick every tick_us microseconds */
+        explicit NeoPixelBeatClock(uint32_t tick_us);
+
+        /* ticks_per_beat ticks per beat at bpm beats per minute. Ticks 
+           needn't be a whole number of microseconds apart */
+        NeoPixelBeatClock(uint16_t bpm, uint8_t ticks_per_beat);
+
+        /* Puts tick 0 at origin_us and clears the overrun counts */
+        void start(uint64_t origin_us);
+
+        /* Time (us since boot) of a tick */
+        uint64_t deadline(uint32_t tick) const;
+
+        /* Last tick waited for */
+        uint32_t tick() const { return cursor; }
+
+        /* Sleeps until a tick. Returns how late it already was in us, 0 
+           when on time */
+        uint32_t waitUntil(uint32_t tick);
+
+        /* Sleeps until ticks after the last tick waited for */
+        uint32_t wait(uint32_t ticks = 1) { return waitUntil(cursor + ticks); }
+
+        /* Number of ticks that were already past when waited for */
+        uint32_t overruns() const { return overrun_count; }
+
+        /* Largest overrun so far, in us */
+        uint32_t worstOverrun() const { return overrun_max; }
+
+    private:
+        /* Records lateness (us) if it is an overrun */
+        void noteOverrun(uint64_t lateness);
+
+        friend class BeatEffect;
+
+        uint64_t origin_us = 0;
+        //tick length is num/den us
+        uint64_t num;
+        uint32_t den;
+        uint32_t cursor = 0;
+        uint32_t overrun_count = 0, overrun_max = 0;
+};
+
+/* Base for effects whose frames fall on a beat grid rather than a fixed 
+   wait after the previous frame */
+class BeatEffect : public NeoPixelEffect {
+    public:
+        explicit BeatEffect(const NeoPixelBeatClock &clock): clock(clock) {}
+
+        /* The grid, with its overrun counts */
+        const NeoPixelBeatClock &beat() const { return clock; }
+
+    protected:
+        /* Puts tick 0 and the first frame at now_us */
+        void startGrid(uint64_t now_us);
+
+        /* Makes the frame ticks later on the grid due. Counts an overrun 
+           if that time has already passed at now_us */
+        void nextBeat(uint64_t now_us, uint32_t ticks = 1) {
+            beatAt(now_us, clock.cursor + ticks);
+        }
+
+        /* Makes the frame at a tick due. Counts an overrun if that time 
+           has already passed at now_us, once per tick */
+        void beatAt(uint64_t now_us, uint32_t tick);
+
+        NeoPixelBeatClock clock;
+
+    private:
+        //the overrun of the current tick has been counted
+        bool late = false;
+};
+
+/* Fill strip pixels one after another with a color. */
+class ColorWipeEffect : public NeoPixelEffect {
+    public:
+        ColorWipeEffect(NeoPixelStrip &np, uint32_t color, int wait);
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        NeoPixelStrip &np;
+        uint32_t color;
+        int wait;
+        int frame = 0;
+};
+
+/* Theater-marquee-style chasing lights. */
+class TheaterChaseEffect : public NeoPixelEffect {
+    public:
+        TheaterChaseEffect(NeoPixelStrip &np, uint32_t color, int wait);
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        NeoPixelStrip &np;
+        uint32_t color;
+        int wait;
+        int frame = 0;
+};
+
+/* Rainbow cycle along whole strip. */
+class RainbowEffect : public NeoPixelEffect {
+    public:
+        RainbowEffect(NeoPixelStrip &np, int wait);
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        NeoPixelStrip &np;
+        int wait;
+        long firstPixelHue = 0;
+};
+
+/* Rainbow-enhanced theater marquee. */
+class TheaterChaseRainbowEffect : public NeoPixelEffect {
+    public:
+        TheaterChaseRainbowEffect(NeoPixelStrip &np, int wait);
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        NeoPixelStrip &np;
+        int wait;
+        int frame = 0;
+        int firstPixelHue = 0;
+};
+
+/* Fades between two opposing colors for a given number of repetitions */
+class AltOppFadeEffect : public NeoPixelEffect {
+    public:
+        AltOppFadeEffect(
+            NeoPixelStrip &np,
+            uint32_t color_1,
+            uint32_t color_2,
+            uint8_t repetitions = 3,
+            uint16_t wait = 50,
+            uint8_t min_step = 2,
+            uint8_t max_step = 10
+        );
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        /* Loads the colors of repetition rep */
+        void beginRepetition();
+
+        NeoPixelStrip &np;
+        uint32_t color_1, color_2;
+        uint8_t repetitions;
+        uint16_t wait;
+        uint8_t min_step, max_step;
+        int rep = 0;
+        //colors the current repetition fades from/to
+        uint32_t from, to;
+        //transition[0] fades towards to, transition[1] towards from
+        uint32_t transition[2];
+};
+
+/* Easing curves for the timed transitions */
+enum class NeoPixelEasing : uint8_t {
+    Linear,
+    EaseIn,     // quadratic, starts slow
+    EaseOut,    // quadratic, ends slow
+    EaseInOut,  // quadratic, slow at both ends
+    Cubic       // cubic, slow at both ends
+};
+
+/* Maps a progress value through an easing curve. Both are 16.16 fixed 
+   point, 0 to 65536 (1.0) */
+uint32_t easeProgress(NeoPixelEasing easing, uint32_t progress);
+
+/* Blends two packed colors byte by byte, progress 0 (from) to 65536 (to) */
+uint32_t lerpColor(uint32_t from, uint32_t to, uint32_t progress);
+
+/* Base for transitions that take a fixed time whatever the color distance.
+   Each frame is computed from the elapsed time, so dropped or late frames
+   don't stretch the transition; the last frame lands on the end time. */
+class TimedTransition : public NeoPixelEffect {
+    public:
+        TimedTransition(
+            uint32_t duration_ms, NeoPixelEasing easing, uint16_t frame_ms
+        );
+
+    protected:
+        /* Starts the clock */
+        void startClock(uint64_t now_us);
+
+        /* Eased progress at now_us, 0 to 65536 */
+        uint32_t progressAt(uint64_t now_us) const;
+
+        /* Sets nextDue() to the next frame, not later than the end time */
+        void scheduleNext(uint64_t now_us);
+
+        uint64_t start_us = 0;
+        uint64_t duration_us;
+        NeoPixelEasing easing;
+        uint32_t frame_us;
+};
+
+/* Transitions all pixels to a color over a fixed time */
+class TransitionAllEffect : public TimedTransition {
+    public:
+        TransitionAllEffect(
+            NeoPixelStrip &np,
+            uint32_t finish_color,
+            uint32_t duration_ms,
+            NeoPixelEasing easing = NeoPixelEasing::Linear,
+            uint16_t frame_ms = 20
+        );
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        NeoPixelStrip &np;
+        uint32_t finish_color;
+};
+
+/* Transitions the pixel at a visual position to a color over a fixed time */
+class TransitionSingleEffect : public TimedTransition {
+    public:
+        TransitionSingleEffect(
+            NeoPixelStrip &np,
+            uint16_t pixel,
+            uint32_t finish_color,
+            uint32_t duration_ms,
+            NeoPixelEasing easing = NeoPixelEasing::Linear,
+            uint16_t frame_ms = 20
+        );
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        NeoPixelStrip &np;
+        uint16_t pixel;
+        uint32_t start_color = 0, finish_color;
+};
+
+/* Transitions the strip brightness to a level over a fixed time */
+class TransitionBrightnessEffect : public TimedTransition {
+    public:
+        TransitionBrightnessEffect(
+            NeoPixelStrip &np,
+            uint8_t finish_value,
+            uint32_t duration_ms,
+            NeoPixelEasing easing = NeoPixelEasing::Linear,
+            uint16_t frame_ms = 20
+        );
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        NeoPixelStrip &np;
+        uint8_t start_value = 0, finish_value;
+};
+
+/* Fades any number of single pixels at once, each on its own clock. Every
+   step() advances all active fades and shows the strip once. Slots are a
+   fixed array, so nothing is allocated. retarget() makes the pool due 
+   straight away; start it on a scheduler (again) after retargeting. */
+class PixelTransitionPool : public NeoPixelEffect {
+    public:
+        PixelTransitionPool(NeoPixelStrip &np, uint16_t frame_ms = 20);
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+        /* Starts fading the pixel at a visual position from its current 
+           color to finish_color. A pixel that is already fading changes 
+           course from where it is. When all slots are busy, the fade that 
+           started first is completed to make room. Returns false if the 
+           pixel is out of range */
+        bool retarget(
+            uint16_t pixel,
+            uint32_t finish_color,
+            uint32_t duration_ms,
+            uint64_t now_us,
+            NeoPixelEasing easing = NeoPixelEasing::Linear
+        );
+
+        /* Number of fades in progress */
+        uint16_t active() const;
+
+    private:
+        struct Slot {
+            bool active;
+            uint16_t pixel;
+            NeoPixelEasing easing;
+            uint32_t from, to;
+            uint64_t start_us, duration_us;
+        };
+
+        /* Renders the slot at now_us; returns false once it has finished */
+        bool render(Slot &slot, uint64_t now_us);
+
+        NeoPixelStrip &np;
+        uint32_t frame_us;
+        Slot slots[NEOPIXEL_TRANSITION_SLOTS] = {};
+};
+
+#endif
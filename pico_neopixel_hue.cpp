@@ -0,0 +1,4 @@
+#include "pico_neopixel_hue.h"
+
+// Generated by the compiler; const, so it stays in flash
+constexpr NeoPixelHueTable neopixel_hue_table = makeHueTable();
@@ -0,0 +1,74 @@
+#ifndef PICO_NEOPIXEL_HUE_H_INCLUDED
+#define PICO_NEOPIXEL_HUE_H_INCLUDED
+/* ^^ these are the include guards */
+#include "Adafruit_NeoPixel.hpp"
+#include <stdint.h>
+
+/* Distinct hues of the 8-bit RGB hexcone (see Adafruit_NeoPixel::ColorHSV) */
+constexpr uint16_t NEOPIXEL_HUE_STEPS = 1530;
+
+/* strip.gamma32(strip.ColorHSV(hue)) for each of the distinct hues */
+struct NeoPixelHueTable {
+    uint32_t colors[NEOPIXEL_HUE_STEPS];
+};
+
+/* Builds the table at compile time, the same way ColorHSV() and gamma32()
+   compute one color at full saturation and value */
+constexpr NeoPixelHueTable makeHueTable() {
+    NeoPixelHueTable table{};
+    for (uint16_t hue = 0; hue < NEOPIXEL_HUE_STEPS; hue++) {
+        uint8_t r = 0, g = 0, b = 0;
+        if (hue < 255)       { r = 255;        g = hue;                }
+        else if (hue < 510)  { r = 510 - hue;  g = 255;                }
+        else if (hue < 765)  { g = 255;        b = hue - 510;          }
+        else if (hue < 1020) { g = 1020 - hue; b = 255;                }
+        else if (hue < 1275) { r = hue - 1020; b = 255;                }
+        else                 { r = 255;        b = 1530 - hue;         }
+        table.colors[hue] = (uint32_t)_NeoPixelGammaTable[r] << 16 |
+                            (uint32_t)_NeoPixelGammaTable[g] << 8 |
+                            _NeoPixelGammaTable[b];
+    }
+    return table;
+}
+
+/* The table, in flash */
+extern const NeoPixelHueTable neopixel_hue_table;
+
+/* strip.gamma32(strip.ColorHSV(hue)) with a single table load */
+inline uint32_t neopixelHueColor(uint16_t hue) {
+    uint32_t i = (hue * 1530UL + 32768) >> 16;
+    return neopixel_hue_table.colors[i < NEOPIXEL_HUE_STEPS ? i : 0];
+}
+
+/* Walks round the hue wheel in equal steps, e.g. one step per pixel for a 
+   rainbow along the strip. The position is kept in table entries as 16.16
+   fixed point, so each color is one add, one compare and one load. */
+class NeoPixelHuePhase {
+    public:
+        /* Starts at hue (0-65535, as ColorHSV takes it) and moves num/den 
+           of a full turn per advance() */
+        NeoPixelHuePhase(uint16_t hue, uint32_t num, uint32_t den):
+            phase(hue * 1530UL + 32768),
+            step(den ? (uint32_t)((uint64_t)WHEEL * num / den % WHEEL) : 0) {
+            if (phase >= WHEEL) {
+                phase -= WHEEL;
+            }
+        }
+
+        /* Gamma corrected color at the current position */
+        uint32_t color() const { return neopixel_hue_table.colors[phase >> 16]; }
+
+        /* Moves one step on */
+        void advance() {
+            phase += step;
+            if (phase >= WHEEL) {
+                phase -= WHEEL;
+            }
+        }
+
+    private:
+        static constexpr uint32_t WHEEL = (uint32_t)NEOPIXEL_HUE_STEPS << 16;
+        uint32_t phase, step;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "pico/stdlib.h"
+#include "pico_neopixel_timeline.h"
+#include "pico_neopixel_animations.h"
+#include "Adafruit_NeoPixel.hpp"
+
+NeoPixelTimelinePlayer::NeoPixelTimelinePlayer(
+    NeoPixelStrip &np, const NeoPixelTimeline &timeline, uint16_t frame_ms
+):
+    BeatEffect(NeoPixelBeatClock(1)), np(np), timeline(timeline), 
+    frame_us(frame_ms ? frame_ms * 1000UL : 1000UL) {}
+
+void NeoPixelTimelinePlayer::begin(uint64_t now_us) {
+    startGrid(now_us);
+    cursor = 0;
+    for (Fade &fade : fades) {
+        fade.active = false;
+    }
+}
+
+void NeoPixelTimelinePlayer::cancelFades(uint16_t first, uint16_t count) {
+    for (Fade &fade : fades) {
+        if (!fade.brightness && fade.first == first && fade.count == count) {
+            fade.active = false;
+        }
+    }
+}
+
+void NeoPixelTimelinePlayer::startFade(const Fade &start) {
+    Fade *use = nullptr;
+    for (Fade &fade : fades) {
+        bool same = fade.brightness ? start.brightness :
+            (!start.brightness && fade.first == start.first &&
+             fade.count == start.count);
+        if (fade.active && same) {
+            use = &fade;
+            break;
+        }
+        if (!fade.active && !use) {
+            use = &fade;
+        }
+    }
+    if (!use) {
+        // no room: the first fade is finished early to make some
+        use = &fades[0];
+        use->duration_us = 0;
+        renderFade(*use, use->start_us);
+    }
+    *use = start;
+    use->active = true;
+}
+
+void NeoPixelTimelinePlayer::apply(const NeoPixelKeyframe &key, uint64_t at_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    uint16_t n = strip.numPixels();
+    uint16_t first = key.first < n ? key.first : n;
+    uint16_t end = (key.count && key.count < n - first) ? first + key.count : n;
+    uint16_t hue = key.value >> 16;
+    uint8_t sat = key.value >> 8, val = key.value;
+
+    switch (key.action) {
+        case NeoPixelKeyAction::Fill:
+        case NeoPixelKeyAction::FillHSV: {
+            uint32_t color = (key.action == NeoPixelKeyAction::Fill) ?
+                key.value : strip.gamma32(strip.ColorHSV(hue, sat, val));
+            cancelFades(key.first, key.count);
+            for (uint16_t i = first; i < end; i++) {
+                strip.setPixelColor(np.parseOrder(i), color);
+            }
+            break;
+        }
+        case NeoPixelKeyAction::Rainbow:
+            cancelFades(key.first, key.count);
+            for (uint16_t i = first; i < end; i++) {
+                uint16_t pixelHue = hue + (i - first) * 65536L / (end - first);
+                strip.setPixelColor(
+                    np.parseOrder(i),
+                    strip.gamma32(strip.ColorHSV(pixelHue, sat, val))
+                );
+            }
+            break;
+        case NeoPixelKeyAction::Fade:
+            if (first < end) {
+                startFade(Fade{
+                    true, false, key.first, key.count, key.easing,
+                    strip.getPixelColor(np.parseOrder(first)), key.value,
+                    at_us, key.duration_ms * 1000ULL
+                });
+            }
+            break;
+        case NeoPixelKeyAction::Brightness:
+            if (key.duration_ms == 0) {
+                // at once, dropping a brightness fade still running
+                for (Fade &fade : fades) {
+                    fade.active = fade.active && !fade.brightness;
+                }
+                NeoPixelStrip::brightness = key.value;
+                strip.updateBrightnessFunctions();
+                break;
+            }
+            startFade(Fade{
+                true, true, 0, 0, key.easing,
+                NeoPixelStrip::brightness, key.value & 0xFF,
+                at_us, key.duration_ms * 1000ULL
+            });
+            break;
+    }
+}
+
+void NeoPixelTimelinePlayer::renderFade(Fade &fade, uint64_t now_us) {
+    Adafruit_NeoPixel &strip = np.strip;
+    uint16_t n = strip.numPixels();
+    uint32_t progress = 65536;
+    uint64_t elapsed = now_us > fade.start_us ? now_us - fade.start_us : 0;
+    if (elapsed < fade.duration_us) {
+        progress = easeProgress(
+            fade.easing, (uint32_t)((elapsed << 16) / fade.duration_us)
+        );
+    }
+    if (fade.brightness) {
+        NeoPixelStrip::brightness = lerpColor(fade.from, fade.to, progress);
+        strip.updateBrightnessFunctions();
+    } else {
+        uint32_t color = lerpColor(fade.from, fade.to, progress);
+        uint16_t first = fade.first < n ? fade.first : n;
+        uint16_t end = (fade.count && fade.count < n - first) ?
+            first + fade.count : n;
+        for (uint16_t i = first; i < end; i++) {
+            strip.setPixelColor(np.parseOrder(i), color);
+        }
+    }
+    fade.active = progress < 65536;
+}
+
+bool NeoPixelTimelinePlayer::renderFades(uint64_t now_us) {
+    bool any = false;
+    for (Fade &fade : fades) {
+        if (fade.active) {
+            renderFade(fade, now_us);
+            any = true;
+        }
+    }
+    return any;
+}
+
+bool NeoPixelTimelinePlayer::step(uint64_t now_us) {
+    bool changed = false;
+    while (cursor < timeline.count &&
+           clock.deadline(timeline.keys[cursor].time_us) <= now_us) {
+        apply(timeline.keys[cursor], clock.deadline(timeline.keys[cursor].time_us));
+        cursor++;
+        changed = true;
+    }
+    changed |= renderFades(now_us);
+    if (changed) {
+        np.strip.show();
+    }
+
+    bool fading = false;
+    for (const Fade &fade : fades) {
+        fading |= fade.active;
+    }
+    if (cursor >= timeline.count && !fading) {
+        np.updateStateColors();
+        return false;
+    }
+    next_due = UINT64_MAX;
+    if (cursor < timeline.count) {
+        // an overrun if rendering and showing this frame took us past it
+        beatAt(time_us_64(), timeline.keys[cursor].time_us);
+    }
+    if (fading && now_us + frame_us < next_due) {
+        next_due = now_us + frame_us;
+    }
+    return true;
+}
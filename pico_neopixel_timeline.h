@@ -0,0 +1,101 @@
+#ifndef PICO_NEOPIXEL_TIMELINE_H_INCLUDED
+#define PICO_NEOPIXEL_TIMELINE_H_INCLUDED
+/* ^^ these are the include guards */
+#include "pico/stdlib.h"
+#include "pico_neopixel_effects.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef NEOPIXEL_TIMELINE_FADES
+#define NEOPIXEL_TIMELINE_FADES 4 // fades a timeline can have running at once
+#endif
+
+/* What a keyframe does to its range of pixels */
+enum class NeoPixelKeyAction : uint8_t {
+    Fill,       // value is a packed RGB color, set at once
+    FillHSV,    // value is keyHSV(), gamma corrected and set at once
+    Rainbow,    // value is keyHSV() of the first pixel, the hue runs once
+                // round the color wheel along the range; gamma corrected
+    Fade,       // from the color of the range's first pixel to the packed 
+                // RGB value, over duration_ms
+    Brightness  // strip brightness to value over duration_ms, 0 sets it 
+                // at once. The range is ignored
+};
+
+/* One entry of a timeline. Plain data, so timelines can be constexpr 
+   arrays that stay in flash */
+struct NeoPixelKeyframe {
+    uint32_t time_us;           // from the start of the timeline
+    uint16_t first, count;      // visual range, count 0 reaches the end
+    NeoPixelKeyAction action;
+    NeoPixelEasing easing;      // Fade and Brightness
+    uint32_t value;
+    uint32_t duration_ms;       // Fade and Brightness
+};
+
+/* Packs a hue (0-65535), saturation and value for FillHSV and Rainbow */
+constexpr uint32_t keyHSV(uint16_t hue, uint8_t sat, uint8_t val) {
+    return (uint32_t)hue << 16 | (uint32_t)sat << 8 | val;
+}
+
+/* Keyframes sorted by time */
+struct NeoPixelTimeline {
+    const NeoPixelKeyframe *keys;
+    uint16_t count;
+};
+
+template <size_t N>
+constexpr NeoPixelTimeline makeTimeline(const NeoPixelKeyframe (&keys)[N]) {
+    return NeoPixelTimeline{keys, (uint16_t)N};
+}
+
+/* Plays a timeline: applies each keyframe when its time comes and renders
+   the running fades in between, showing the strip once per frame. The 
+   keyframe times are ticks of a 1 us beat grid put at begin(), so late 
+   frames don't delay the ones after them; a frame that runs past the next
+   keyframe counts as an overrun of the grid, see beat(). Allocates 
+   nothing. */
+class NeoPixelTimelinePlayer : public BeatEffect {
+    public:
+        NeoPixelTimelinePlayer(
+            NeoPixelStrip &np,
+            const NeoPixelTimeline &timeline,
+            uint16_t frame_ms = 20
+        );
+        void begin(uint64_t now_us) override;
+        bool step(uint64_t now_us) override;
+
+    private:
+        struct Fade {
+            bool active;
+            bool brightness;
+            uint16_t first, count;
+            NeoPixelEasing easing;
+            uint32_t from, to;
+            uint64_t start_us, duration_us;
+        };
+
+        /* Carries out a keyframe that was due at at_us */
+        void apply(const NeoPixelKeyframe &key, uint64_t at_us);
+
+        /* Starts a fade, replacing one of the same range (or the running 
+           brightness fade) */
+        void startFade(const Fade &fade);
+
+        /* Drops color fades of exactly this range */
+        void cancelFades(uint16_t first, uint16_t count);
+
+        /* Renders one fade at now_us, deactivating it once it's done */
+        void renderFade(Fade &fade, uint64_t now_us);
+
+        /* Renders the fades at now_us. Returns true if there were any */
+        bool renderFades(uint64_t now_us);
+
+        NeoPixelStrip &np;
+        NeoPixelTimeline timeline;
+        uint32_t frame_us;
+        uint16_t cursor = 0;
+        Fade fades[NEOPIXEL_TIMELINE_FADES] = {};
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "pico/stdlib.h"
+#include "pico_neopixel_trace.h"
+#include "NeoPixelLock.hpp"
+#include <stdio.h>
+
+static const char *const neopixel_trace_names[TRACE_EVENT_COUNT] = {
+    "parse_speed",
+    "parse_brightness",
+    "state_colors",
+    "single_pixel",
+    "transition_all",
+    "pixel_color",
+    "beat_overruns",
+};
+
+static NeoPixelTraceRecord trace_ring[NEOPIXEL_TRACE_LENGTH];
+static uint32_t trace_next = 0;     // total records ever logged, under NeoPixelLock
+
+void neopixel_trace(uint16_t event, uint32_t a, uint32_t b) {
+    uint32_t now = time_us_32();
+    NeoPixelLock lock;
+    NeoPixelTraceRecord &r = trace_ring[trace_next % NEOPIXEL_TRACE_LENGTH];
+    r.time_us = now;
+    r.event = event;
+    r.core = get_core_num();
+    r.a = a;
+    r.b = b;
+    trace_next++;
+}
+
+// Copies the newest records, oldest first. Call with the lock held
+static uint16_t trace_copy(NeoPixelTraceRecord *out, uint16_t max) {
+    uint32_t count = trace_next < NEOPIXEL_TRACE_LENGTH ?
+        trace_next : NEOPIXEL_TRACE_LENGTH;
+    if (count > max) {
+        count = max;
+    }
+    uint32_t first = trace_next - count;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = trace_ring[(first + i) % NEOPIXEL_TRACE_LENGTH];
+    }
+    return count;
+}
+
+uint16_t neopixel_trace_read(NeoPixelTraceRecord *out, uint16_t max) {
+    NeoPixelLock lock;
+    return trace_copy(out, max);
+}
+
+void neopixel_trace_dump() {
+    // copy out and empty the ring first, so printing doesn't hold the lock
+    static NeoPixelTraceRecord copy[NEOPIXEL_TRACE_LENGTH];
+    uint32_t dropped;
+    uint16_t count;
+    {
+        NeoPixelLock lock;
+        dropped = trace_next > NEOPIXEL_TRACE_LENGTH ?
+            trace_next - NEOPIXEL_TRACE_LENGTH : 0;
+        count = trace_copy(copy, NEOPIXEL_TRACE_LENGTH);
+        trace_next = 0;
+    }
+
+    printf("trace: %d records, %lu overwritten\n", count, (unsigned long)dropped);
+    for (int i = 0; i < count; i++) {
+        const NeoPixelTraceRecord &r = copy[i];
+        const char *name = r.event < TRACE_EVENT_COUNT ?
+            neopixel_trace_names[r.event] : "?";
+        printf("%10lu core%d %-16s %8lx %8lx\n", (unsigned long)r.time_us,
+            r.core, name, (unsigned long)r.a, (unsigned long)r.b);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef PICO_NEOPIXEL_TRACE_H_INCLUDED
+#define PICO_NEOPIXEL_TRACE_H_INCLUDED
+/* ^^ these are the include guards */
+#include <stdint.h>
+
+#ifndef NEOPIXEL_TRACE_LENGTH
+#define NEOPIXEL_TRACE_LENGTH 256 // records kept, older ones are overwritten
+#endif
+
+/* What a trace record was logged for. Keep neopixel_trace_names in 
+   pico_neopixel_trace.cpp in step */
+enum NeoPixelTraceEvent : uint16_t {
+    TRACE_PARSE_SPEED,          // a: slider value, b: delay (ms)
+    TRACE_PARSE_BRIGHTNESS,     // a: slider value, b: brightness
+    TRACE_STATE_COLORS,         // a: power color, b: led 1 color
+    TRACE_SINGLE_PIXEL,         // a: visual position, b: electrical index
+    TRACE_TRANSITION_ALL,       // a: power color, b: finish color
+    TRACE_PIXEL_COLOR,          // a: electrical index, b: color
+    TRACE_BEAT_OVERRUNS,        // a: ticks overrun, b: worst overrun (us)
+    TRACE_EVENT_COUNT
+};
+
+/* One fixed-size binary record, cheap enough to log from a frame loop */
+struct NeoPixelTraceRecord {
+    uint32_t time_us;   // low 32 bits of time_us_64()
+    uint16_t event;     // a NeoPixelTraceEvent
+    uint16_t core;      // core that logged it
+    uint32_t a, b;
+};
+
+/* Appends a record to the trace ring. Safe from both cores and from 
+   interrupts */
+void neopixel_trace(uint16_t event, uint32_t a, uint32_t b);
+
+/* Copies up to max records, oldest first, into out. Returns the number 
+   copied */
+uint16_t neopixel_trace_read(NeoPixelTraceRecord *out, uint16_t max);
+
+/* Prints the records kept so far over stdio, oldest first, then empties 
+   the trace */
+void neopixel_trace_dump();
+
+#endif
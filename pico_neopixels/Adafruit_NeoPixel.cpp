@@ -46,6 +46,11 @@
 #include "Adafruit_NeoPixel.hpp"
 #include "pico/stdio.h"
 #include "pico/malloc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "NeoPixelLock.hpp"
+#include "NeoPixelStats.hpp"
 //#include "pico/mem_ops.h"
 #include <cstdlib>
 #include <cstring>
@@ -66,6 +71,17 @@
 #define PRINTF1(...)
 #endif
 
+// strips owning each DMA channel, so the shared DMA_IRQ_0 handler can find
+// the object whose transfer just finished. 
+static Adafruit_NeoPixel *dma_owner[NUM_DMA_CHANNELS] = {NULL};
+static bool dma_irq_installed = false;
+// DMA_IRQ_0 is enabled in each core's own NVIC, see rp2040EnableDmaIrq()
+static bool dma_irq_enabled[NUM_CORES] = {false};
+#ifdef NEOPIXEL_STATS
+// when each channel's transfer started, for NEOPIXEL_STAT_TRANSMIT
+static uint32_t dma_start_us[NUM_DMA_CHANNELS];
+#endif
+
 
 /*!
   @brief   NeoPixel constructor when length, pin and pixel type are known
@@ -80,7 +96,8 @@
   @return  Adafruit_NeoPixel object. Call the begin() function before use.
 */
 Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, uint16_t p, neoPixelType t) :
-  begun(false), brightness(0), pixels(NULL), opixels(NULL), brightfr(NULL), brightfg(NULL), brightfb(NULL), brightfw(NULL)  {
+  begun(false), numLEDs(0), numBytes(0), brightness(0), pixels(NULL), opixels(NULL), fifoWords(NULL), brightTable(NULL), scaleOnShow(false), staticBuffers(false), staticTable(false), bufferLEDs(0), bufferBytes(0),
+  dirtyEnd(0), sm(-1), pioOffset(0), pioStatus(NeoPixelPioStatus::Unclaimed), brightfr(NULL), brightfg(NULL), brightfb(NULL), brightfw(NULL), dmaChannel(-1), dmaBusy(false), showDone(NULL), showDoneContext(NULL)  {
   PRINTF1("In constructor 1\n");
   endTime = get_absolute_time() ;
   PRINTF1("In constructor 2\n");
@@ -92,6 +109,36 @@ Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, uint16_t p, neoPixelType t) :
 
 }
 
+/*!
+  @brief   NeoPixel constructor that uses caller-provided buffers instead
+           of the heap, e.g. the members of a static NeoPixelStaticBuffers.
+           The buffers must outlive the object and are never freed.
+  @param   n            Number of NeoPixels in strand.
+  @param   p            Arduino pin number which will drive the NeoPixel
+                        data in.
+  @param   t            Pixel type, as for the first constructor.
+  @param   pixelBuffer  Pixel buffer, n * 3 bytes for RGB or n * 4 bytes
+                        for RGBW pixels.
+  @param   pixelBytes   Size of pixelBuffer in bytes. If it is too small
+                        for n pixels of type t, numPixels() is 0.
+  @param   fifoBuffer   n words, the DMA staging buffer.
+  @param   tableBuffer  4 * 256 bytes for the brightness functions, or NULL
+                        if none will be installed. Brightness is applied on
+                        show, as a copy of the pixels would need the heap.
+  @return  Adafruit_NeoPixel object. Call the begin() function before use.
+  @note    updateLength() can't go beyond the buffers; a longer length
+           fails like an allocation failure (numPixels() becomes 0).
+*/
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, uint16_t p, neoPixelType t,
+  uint8_t *pixelBuffer, uint16_t pixelBytes, uint32_t *fifoBuffer, uint8_t *tableBuffer) :
+  begun(false), numLEDs(0), numBytes(0), brightness(0), pixels(pixelBuffer), opixels(NULL), fifoWords(fifoBuffer), brightTable(tableBuffer), scaleOnShow(true), staticBuffers(true), staticTable(tableBuffer != NULL), bufferLEDs(n), bufferBytes(pixelBytes),
+  rOffset(1), gOffset(0), bOffset(2), wOffset(1), dirtyEnd(0), sm(-1), pioOffset(0), pioStatus(NeoPixelPioStatus::Unclaimed), brightfr(NULL), brightfg(NULL), brightfb(NULL), brightfw(NULL), dmaChannel(-1), dmaBusy(false), showDone(NULL), showDoneContext(NULL) {
+  endTime = get_absolute_time() ;
+  setPin(p);
+  updateType(t);
+  updateLength(n);
+}
+
 /*!
   @brief   "Empty" NeoPixel constructor when length, pin and/or pixel type
            are not known at compile-time, and must be initialized later with
@@ -106,7 +153,8 @@ Adafruit_NeoPixel::Adafruit_NeoPixel() :
 #if defined(NEO_KHZ400)
   is800KHz(true),
 #endif
-  begun(false), numLEDs(0), numBytes(0), pin(-1), brightness(0), pixels(NULL), opixels(NULL), brightfr(NULL), brightfg(NULL), brightfb(NULL), brightfw(NULL), rOffset(1), gOffset(0), bOffset(2), wOffset(1){
+  begun(false), numLEDs(0), numBytes(0), pin(-1), brightness(0), pixels(NULL), opixels(NULL), fifoWords(NULL), brightTable(NULL), scaleOnShow(false), staticBuffers(false), staticTable(false), bufferLEDs(0), bufferBytes(0),
+  rOffset(1), gOffset(0), bOffset(2), wOffset(1), dirtyEnd(0), sm(-1), pioOffset(0), pioStatus(NeoPixelPioStatus::Unclaimed), brightfr(NULL), brightfg(NULL), brightfb(NULL), brightfw(NULL), dmaChannel(-1), dmaBusy(false), showDone(NULL), showDoneContext(NULL) {
   endTime = get_absolute_time();
 }
 
@@ -115,22 +163,34 @@ Adafruit_NeoPixel::Adafruit_NeoPixel() :
 */
 Adafruit_NeoPixel::~Adafruit_NeoPixel() {
   PRINTF0("In destructor\n  ===>\n");
-  memset(pixels, 0, numBytes);
-  show() ;
-  sleep_ms(20) ;
-  PRINTF1("End init = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, no_sm = [%d, %d]\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, (pio_get_index(pio) == 0) ? pio0_offset : pio1_offset,pio_no_sm[0], pio_no_sm[1] );
+  waitShowDone();
+  if (sm != -1) { // blank the strip, unless it never got to transmit
+	  memset(pixels, 0, numBytes);
+	  show() ;
+	  sleep_ms(20) ;
+  };
+  if (dmaChannel != -1) { // release the DMA channel
+	  dma_channel_set_irq0_enabled(dmaChannel, false);
+	  dma_owner[dmaChannel] = NULL;
+	  dma_channel_unclaim(dmaChannel);
+	  dmaChannel = -1;
+  };
+  PRINTF1("End init = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, status = %s\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, pioOffset, NeoPixelPioRegistry::statusName(pioStatus));
   PRINTF1("going to free\n");
-  free(pixels);  // unclaim the memory for the pixels
+  if (!staticBuffers) {
+    free(pixels);  // unclaim the memory for the pixels
+    free(fifoWords); // unclaim the DMA staging buffer
+  }
   free(opixels); // unclaim the memory for the pixels
+  if (!staticTable) free(brightTable); // unclaim the brightness tables
   PRINTF1("freed pixels\n");
-  pio_sm_unclaim(pio,sm); // unclaim the state machine
-  pio_no_sm[pio_get_index(pio)]-- ;
-  if (pio_no_sm[pio_get_index(pio)] == 0 ) { // if no sm on the pio instance, remove the program
-	  pio_remove_program (pio, &ws2812byte_program, (pio_get_index(pio) == 0) ? pio0_offset : pio1_offset );
-	  if (pio_get_index(pio) == 0) {pio0_offset = -1;} else {pio1_offset = -1;}; 
+  if (sm != -1) { // unclaim the state machine, and the program with its last user
+	  NeoPixelPioClaim claim = {pio, (int)sm, pioOffset};
+	  NeoPixelPioRegistry::release(&ws2812byte_program, claim);
+	  sm = -1;
   };
  
- PRINTF0("End destruructor = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, no_sm = [%d, %d]\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, (pio_get_index(pio) == 0) ? pio0_offset : pio1_offset,pio_no_sm[0], pio_no_sm[1] );
+ PRINTF0("End destruructor = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, status = %s\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, pioOffset, NeoPixelPioRegistry::statusName(pioStatus));
 }
 
 /*!
@@ -141,6 +201,17 @@ void Adafruit_NeoPixel::begin(void) {
  // PRINTF0("In begin Begun = %d, pin = %d, length = %d\n", begun, pin, numLEDs);
 }
 
+/*!
+  @brief   Claim the state machine and DMA channel now instead of on the
+           first show().
+  @return  true if the strip is sent by DMA; false if it got no state
+           machine (see getPioStatus()) or is fed by the CPU.
+*/
+bool Adafruit_NeoPixel::beginDma(void) {
+  if (!begun) rp2040Init(pin);
+  return sm != -1 && dmaChannel != -1 && fifoWords != NULL;
+}
+
 /*!
   @brief   Change the length of a previously-declared Adafruit_NeoPixel
            strip object. Old data is deallocated and new data is cleared.
@@ -152,7 +223,21 @@ void Adafruit_NeoPixel::begin(void) {
            type).
 */
 void Adafruit_NeoPixel::updateLength(uint16_t n) {
+  waitShowDone(); // the staging buffer may still be in use
+  if (staticBuffers) {
+    // the caller's buffers are all there is
+    numBytes = n * ((wOffset == rOffset) ? 3 : 4);
+    if (n <= bufferLEDs && numBytes <= bufferBytes) {
+      memset(pixels, 0, numBytes);
+      numLEDs = n;
+    } else {
+      numLEDs = numBytes = 0;
+    }
+    dirtyEnd = numLEDs;
+    return;
+  }
   free(pixels); // Free existing data (if any)
+  free(fifoWords);
 
   // Allocate new data -- note: ALL PIXELS ARE CLEARED
   numBytes = n * ((wOffset == rOffset) ? 3 : 4);
@@ -162,8 +247,11 @@ void Adafruit_NeoPixel::updateLength(uint16_t n) {
   } else {
     numLEDs = numBytes = 0;
   }
+  // One FIFO word per pixel for DMA transfers. Without it show() falls back
+  // to feeding the state machine from the CPU.
+  fifoWords = (uint32_t *)malloc(numLEDs * sizeof(uint32_t));
   
-  if (brightfr != NULL) {
+  if (brightfr != NULL && !scaleOnShow) {
 	  free(opixels) ;
 	  if((opixels = (uint8_t *)malloc(numBytes))) {
 			memset(opixels, 0, numBytes);
@@ -172,7 +260,7 @@ void Adafruit_NeoPixel::updateLength(uint16_t n) {
 			numLEDs = numBytes = 0;
 	  };
   };
-  
+  dirtyEnd = numLEDs; // all cleared, so all to be sent
 }
 
 /*!
@@ -202,83 +290,88 @@ void Adafruit_NeoPixel::updateType(neoPixelType t) {
 #if defined(NEO_KHZ400)
   is800KHz = (t < 256);      // 400 KHz flag is 1<<8
 #endif
+  dirtyEnd = numLEDs;
 
   // If bytes-per-pixel has changed (and pixel data was previously
   // allocated), re-allocate to new size. Will clear any data.
   if(pixels) {
     bool newThreeBytesPerPixel = (wOffset == rOffset);
-    if(newThreeBytesPerPixel != oldThreeBytesPerPixel) updateLength(numLEDs);
+    if(newThreeBytesPerPixel != oldThreeBytesPerPixel) {
+      updateLength(numLEDs);
+      // the state machine pulls a whole pixel per FIFO word, so its
+      // autopull threshold has to follow the new pixel size
+      if(begun && sm != -1) rp2040changepin(pin);
+    }
   }
+  // the brightness tables are laid out by byte offset
+  updateBrightnessFunctions();
 }
 
 
 void Adafruit_NeoPixel::rp2040Init(uint8_t set_pin)
 {
 	PRINTF0("IN RP2040 INIT now\n"); 
-    // get free sm & pio and store these in the protected variables of the class 
-    int resultsm;
-	bool canpio;
-	resultsm = pio_claim_unused_sm(pio0,false);
-	PRINTF1("resultsm = %d\n",resultsm);
-	if (resultsm != -1) {
-		if (pio0_offset == -1) {
-			canpio = pio_can_add_program(pio0, &ws2812byte_program);
-			PRINTF1("canpio = %d\n",canpio);
-			if (canpio) pio0_offset = pio_add_program(pio0, &ws2812byte_program);
-		};
-		pio = pio0;
-	};
-	if (resultsm == -1 || pio0_offset == -1) {
-		resultsm = pio_claim_unused_sm(pio1,false);
-		if (resultsm != -1) {
-			if (pio1_offset == -1) {
-				canpio = pio_can_add_program(pio1, &ws2812byte_program);
-				if (canpio) pio1_offset = pio_add_program(pio0, &ws2812byte_program);
-			};
-			pio = pio1;
-		}
-	};
-	
-	if (resultsm == -1 || (pio0_offset == -1 && pio1_offset == -1)) {
-		sm = -1 ;
+    // get free sm & pio (loading the program there if needed) and store
+    // these in the protected variables of the class 
+	NeoPixelPioClaim claim;
+	pioStatus = NeoPixelPioRegistry::claim(&ws2812byte_program, claim);
+	PRINTF1("claim = %s\n", NeoPixelPioRegistry::statusName(pioStatus));
+	if (pioStatus != NeoPixelPioStatus::Ok) {
+		sm = -1 ; // retried on the next show, a strip may have been freed
 		return ;
 	}
-
-	pio_no_sm[pio_get_index(pio)]++ ;
 					 
+	pio = claim.pio ;
+	pioOffset = claim.offset ;
 	pin = set_pin ;
-	sm = resultsm ;
+	sm = claim.sm ;
 	
-	PRINTF1("End init = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, no_sm = [%d, %d]\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, (pio_get_index(pio) == 0) ? pio0_offset : pio1_offset,pio_no_sm[0], pio_no_sm[1] );
+	PRINTF1("End init = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, status = %s\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, pioOffset, NeoPixelPioRegistry::statusName(pioStatus));
 	
     if (is800KHz)
     {
-        // 800kHz, 8 bit transfers
-        ws2812byte_program_init(pio, sm, (pio_get_index(pio) == 0) ? pio0_offset : pio1_offset, pin, 800000, 8);
+        // 800kHz, one pixel (24 or 32 bits) per transfer
+        ws2812byte_program_init(pio, sm, pioOffset, pin, 800000, bitsPerPixel());
     }
     else
     {
-        // 400kHz, 8 bit transfers
-        ws2812byte_program_init(pio, sm, (pio_get_index(pio) == 0) ? pio0_offset : pio1_offset, pin, 400000, 8);
+        // 400kHz, one pixel (24 or 32 bits) per transfer
+        ws2812byte_program_init(pio, sm, pioOffset, pin, 400000, bitsPerPixel());
     } ;
+	
+	// Claim a DMA channel to feed the state machine. When none is left the
+	// strip silently falls back to the CPU driven transfer in rp2040Show().
+	dmaChannel = dma_claim_unused_channel(false);
+	if (dmaChannel != -1) {
+		dma_channel_config c = dma_channel_get_default_config(dmaChannel);
+		// one packed pixel per transfer, see packFifoWords()
+		channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+		channel_config_set_read_increment(&c, true);
+		channel_config_set_write_increment(&c, false);
+		channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+		dma_channel_configure(dmaChannel, &c, &pio->txf[sm], NULL, 0, false);
+
+		dma_owner[dmaChannel] = this;
+		dma_channel_set_irq0_enabled(dmaChannel, true);
+		rp2040EnableDmaIrq();
+	};
 	begun = true ;
-	PRINTF0("exit INIT pio %d, sm %d\n", pio_get_index(pio),sm);
+	PRINTF0("exit INIT pio %d, sm %d, dma %d\n", pio_get_index(pio),sm, dmaChannel);
 }
 
 void Adafruit_NeoPixel::rp2040changepin(uint8_t set_pin)
 {
 	pin = set_pin ;
-	int resultpio = pio_get_index(pio);
-	
+	if (sm == -1) return ;
     if (is800KHz)
     {
-        // 800kHz, 8 bit transfers
-        ws2812byte_program_init(pio, sm, (resultpio == 0) ? pio0_offset : pio1_offset, pin, 800000, 8);
+        // 800kHz, one pixel (24 or 32 bits) per transfer
+        ws2812byte_program_init(pio, sm, pioOffset, pin, 800000, bitsPerPixel());
     }
     else
     {
-        // 400kHz, 8 bit transfers
-        ws2812byte_program_init(pio, sm, (resultpio == 0) ? pio0_offset : pio1_offset, pin, 400000, 8);
+        // 400kHz, one pixel (24 or 32 bits) per transfer
+        ws2812byte_program_init(pio, sm, pioOffset, pin, 400000, bitsPerPixel());
     }
 }
  
@@ -294,10 +387,108 @@ void  Adafruit_NeoPixel::rp2040Show(uint8_t pin, uint8_t *pixels, uint32_t numBy
 
     if (sm == -1) { return ; }
 
-//    PRINTF1("START TO SHOW = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, no_sm = [%d, %d]\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, (pio_get_index(pio) == 0) ? pio0_offset : pio1_offset,pio_no_sm[0], pio_no_sm[1] );
-    while(numBytes--)
-        // Bits for transmission must be shifted to top 8 bits
-        pio_sm_put_blocking(pio, sm, ((uint32_t)*pixels++)<< 24);
+    NEOPIXEL_STATS_START(start);
+//    PRINTF1("START TO SHOW = %d, pin = %d, 800kHz = %d, length = %d, pio= %d, sm = %d, offset = %d, status = %s\n ", begun, pin, is800KHz, numLEDs, pio_get_index(pio), sm, pioOffset, NeoPixelPioRegistry::statusName(pioStatus));
+    uint8_t bpp = (wOffset == rOffset) ? 3 : 4;
+    const uint8_t *table = showTable();
+    // One FIFO write per pixel: the state machine autopulls 24 (RGB) or
+    // 32 (RGBW) bits, first transmitted byte in the top 8 bits.
+    if (table) {
+        for (uint32_t i = 0 ; i + bpp <= numBytes ; i += bpp)
+            pio_sm_put_blocking(pio, sm, packPixel(&pixels[i], bpp, table));
+    } else {
+        for (uint32_t i = 0 ; i + bpp <= numBytes ; i += bpp)
+            pio_sm_put_blocking(pio, sm, packPixel(&pixels[i], bpp));
+    }
+    NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_TRANSMIT, start);
+}
+
+// Pack the pixel buffer into fifoWords, one word per pixel in the layout
+// the state machine expects (see packPixel()). Brightness is applied here
+// when scaling on show.
+void Adafruit_NeoPixel::packFifoWords(const uint8_t *pixels, uint16_t n)
+{
+	uint32_t *w = fifoWords;
+	const uint8_t *table = showTable();
+	if (table) {
+		uint8_t bpp = (wOffset == rOffset) ? 3 : 4;
+		for (uint16_t i = 0 ; i < n ; i++, pixels += bpp) *w++ = packPixel(pixels, bpp, table);
+	} else if (wOffset == rOffset) {
+		for (uint16_t i = 0 ; i < n ; i++, pixels += 3) *w++ = packPixel(pixels, 3);
+	} else {
+		for (uint16_t i = 0 ; i < n ; i++, pixels += 4) *w++ = packPixel(pixels, 4);
+	}
+}
+
+// Start a DMA transfer of n packed pixels from fifoWords into the state
+// machine FIFO. Returns immediately; rp2040DmaIrqHandler() clears dmaBusy
+// once the last word has been handed to the FIFO.
+void Adafruit_NeoPixel::rp2040ShowDMA(uint16_t n)
+{
+	rp2040EnableDmaIrq();
+	dmaBusy = true ;
+#ifdef NEOPIXEL_STATS
+	dma_start_us[dmaChannel] = time_us_32();
+#endif
+	dma_channel_transfer_from_buffer_now(dmaChannel, fifoWords, n);
+}
+
+// Add the shared DMA_IRQ_0 handler once, and enable the interrupt on the
+// calling core the first time it claims a channel or starts a transfer.
+// Each core has its own NVIC, so a core that shows can't rely on the
+// other one having enabled it; a core that was reset takes no interrupts.
+void Adafruit_NeoPixel::rp2040EnableDmaIrq(void)
+{
+	uint core = get_core_num();
+	if (dma_irq_enabled[core]) return;
+	{
+		NeoPixelLock lock;
+		if (!dma_irq_installed) {
+			irq_add_shared_handler(DMA_IRQ_0, rp2040DmaIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+			dma_irq_installed = true;
+		}
+	}
+	irq_set_enabled(DMA_IRQ_0, true);
+	dma_irq_enabled[core] = true;
+}
+
+// Set endTime to when the last bit of the frame just handed to the state
+// machine leaves the pin: the words still in the FIFO plus the one being
+// shifted out, counted whole so that the latch is never cut short.
+void Adafruit_NeoPixel::markEndTime(void)
+{
+	uint32_t words = pio_sm_get_tx_fifo_level(pio, sm) + 1;
+	uint32_t bit_ns = is800KHz ? 1250 : 2500;
+	endTime = delayed_by_us(get_absolute_time(), (words * bitsPerPixel() * bit_ns + 999) / 1000);
+}
+
+// Block for what is left of the latch after the previous frame, which is
+// nothing if rendering the next one took longer.
+void Adafruit_NeoPixel::waitLatch(void)
+{
+	while (!canShow()) {
+		tight_loop_contents();
+	}
+}
+
+// Shared DMA_IRQ_0 handler: finds the strips whose transfer has ended,
+// marks them idle and runs their completion callback.
+void Adafruit_NeoPixel::rp2040DmaIrqHandler(void)
+{
+	for (int ch = 0 ; ch < NUM_DMA_CHANNELS ; ch++) {
+		Adafruit_NeoPixel *owner = dma_owner[ch];
+		if (owner == NULL) continue;
+		{
+			// both cores may take the interrupt; only one acknowledges it
+			NeoPixelLock lock;
+			if (!dma_channel_get_irq0_status(ch)) continue;
+			dma_channel_acknowledge_irq0(ch);
+		}
+		NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_TRANSMIT, dma_start_us[ch]);
+		owner->markEndTime();
+		owner->dmaBusy = false ;
+		if (owner->showDone) owner->showDone(owner, owner->showDoneContext);
+	}
 }
 
 
@@ -314,10 +505,113 @@ void  Adafruit_NeoPixel::rp2040Show(uint8_t pin, uint8_t *pixels, uint32_t numBy
 */
 void Adafruit_NeoPixel::show(void) {
 
+  NEOPIXEL_STATS_START(start);
+  showAsync();
+  waitShowDone();
+  NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_SHOW, start);
+
+}
+
+/*!
+  @brief   Start transmitting pixel data in RAM to NeoPixels and return
+           without waiting for the transfer to finish. The data is fed to
+           the PIO state machine by DMA, so the CPU is free to render the
+           next frame meanwhile.
+  @note    The pixels are packed into a separate staging buffer before the
+           transfer starts, so the pixel buffer may be changed as soon as
+           this returns. If a previous transfer is still running this call
+           waits for it first, then for whatever is left of the latch time
+           after its last bit (see canShow()). When no DMA channel is available the
+           transfer is done by the CPU and this call blocks like show().
+*/
+void Adafruit_NeoPixel::showAsync(void) {
+
   if(!pixels) return;
 
-	rp2040Show(pin, pixels, numBytes, is800KHz);
+  startShow(pixels, numLEDs, true);
+}
+
+/*!
+  @brief   Start transmitting a frame held in a buffer other than the pixel
+           buffer, e.g. a snapshot taken by NeoPixelPipeline. Behaves like
+           showAsync() otherwise.
+  @param   frame  getNumBytes() bytes of pixel data in device format (see
+                  getPixels()).
+*/
+void Adafruit_NeoPixel::showAsync(const uint8_t *frame) {
+
+  // the pixel buffer isn't sent, so what changed in it still has to be
+  startShow(frame, numLEDs, false);
+}
+
+/*!
+  @brief   Transmit only as much of the strip as has changed since the last
+           show: every pixel up to the highest index set since then. The
+           pixels past it don't receive data and keep their colors, so a
+           change near the start of a long strip is sent in a fraction of
+           the time. Waits until done, like show().
+  @note    Only changes made through this class are seen; call markDirty()
+           after writing to getPixels() directly.
+*/
+void Adafruit_NeoPixel::showChanged(void) {
+
+  NEOPIXEL_STATS_START(start);
+  if (pixels && dirtyEnd) startShow(pixels, dirtyEnd, true);
+  waitShowDone();
+  NEOPIXEL_STATS_STOP(NEOPIXEL_STAT_SHOW, start);
+}
+
+// Start transmitting the first n pixels of frame, by DMA if there is a
+// channel and by the CPU otherwise. When frame is the pixel buffer
+// (clean), everything set so far is then on its way and nothing is left
+// dirty. Other frames leave dirtyEnd alone: NeoPixelPipeline sends them
+// from core 1 while core 0 keeps setting pixels.
+void Adafruit_NeoPixel::startShow(const uint8_t *frame, uint16_t n, bool clean) {
+
+  if (!begun) {
+    // On first pass through initialise the PIO and DMA
+    rp2040Init(pin);
+  }
+
+  if (sm == -1) { return ; }
+
+  waitShowDone();
+
+  if (clean) dirtyEnd = 0;
+  if (dmaChannel == -1 || fifoWords == NULL) {
+    waitLatch();
+    rp2040Show(pin, (uint8_t *)frame, n * (bitsPerPixel() / 8), is800KHz);
+    markEndTime();
+    if (showDone) showDone(this, showDoneContext);
+    return;
+  }
+
+  // pack while the previous frame drains and latches
+  packFifoWords(frame, n);
+  waitLatch();
+  rp2040ShowDMA(n);
+}
+
+/*!
+  @brief   Block until the transfer started by showAsync() has been handed
+           to the PIO state machine. Returns at once if none is running.
+*/
+void Adafruit_NeoPixel::waitShowDone(void) {
+  while (dmaBusy) {
+    tight_loop_contents();
+  }
+  __compiler_memory_barrier(); // endTime was written by the interrupt
+}
 
+/*!
+  @brief   Install a function called when a showAsync() transfer ends.
+  @param   f        Callback, or NULL to remove it. Runs in interrupt
+                    context when DMA is used, so keep it short.
+  @param   context  Opaque pointer handed back to the callback.
+*/
+void Adafruit_NeoPixel::setShowCompleteCallback(pShowCompleteFunc f, void *context) {
+  showDone = f;
+  showDoneContext = context;
 }
 
 /*!
@@ -360,6 +654,7 @@ void Adafruit_NeoPixel::setPixelColor(
  uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
 
   if(n < numLEDs) {
+    if(n >= dirtyEnd) dirtyEnd = n + 1; // for showChanged()
     if(brightness) { // See notes in setBrightness()
       r = (r * brightness) >> 8;
       g = (g * brightness) >> 8;
@@ -367,7 +662,7 @@ void Adafruit_NeoPixel::setPixelColor(
       w = (w * brightness) >> 8;
     }
     uint8_t *p, *po;
-	if (brightfr == NULL) {
+	if (brightfr == NULL || scaleOnShow) { // pixels holds the colors as set
 		if(wOffset == rOffset) { // Is an RGB-type strip
 			p = &pixels[n * 3];    // 3 bytes per pixel
 		} else {                 // Is a WRGB-type strip
@@ -385,14 +680,21 @@ void Adafruit_NeoPixel::setPixelColor(
 			po = &opixels[n * 4];    // 4 bytes per pixel
 			p  =  &pixels[n * 4];
 			po[wOffset] = w;        // set W
-			p[wOffset] = brightfw(w);
 		}
 		po[rOffset] = r;          // R,G,B always stored
 		po[gOffset] = g;
 		po[bOffset] = b;
-		p[rOffset] = brightfr(r);
-		p[gOffset] = brightfg(g);
-		p[bOffset] = brightfb(b);
+		if (brightTable) {
+			if (wOffset != rOffset) p[wOffset] = brightTable[wOffset * 256 + w];
+			p[rOffset] = brightTable[rOffset * 256 + r];
+			p[gOffset] = brightTable[gOffset * 256 + g];
+			p[bOffset] = brightTable[bOffset * 256 + b];
+		} else {
+			if (wOffset != rOffset) p[wOffset] = brightfw(w);
+			p[rOffset] = brightfr(r);
+			p[gOffset] = brightfg(g);
+			p[bOffset] = brightfb(b);
+		}
 	}
 	
   }
@@ -561,7 +863,7 @@ uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
 
   uint8_t *p, *po;
   
-  if (brightfr == NULL) {
+  if (brightfr == NULL || scaleOnShow) {
 	if(wOffset == rOffset) { // Is RGB-type device
 		p = &pixels[n * 3];
 		if(brightness) {
@@ -656,27 +958,114 @@ void Adafruit_NeoPixel::setBrightness(uint8_t b) {
       *ptr++ = (c * scale) >> 8;
     }
     brightness = newBrightness;
+    dirtyEnd = numLEDs;
   }
 }
 
+/*!
+  @brief   Install per-channel brightness functions. Each function is
+           evaluated once for every input value into a lookup table, and
+           the pixels are rescaled from their original values through it.
+  @param   fr  Function applied to red values.
+  @param   fg  Function applied to green values.
+  @param   fb  Function applied to blue values.
+  @param   fw  Function applied to white values (RGBW strips only).
+  @note    If a function depends on state that changes later (say a global
+           brightness level), call updateBrightnessFunctions() after the
+           change instead of installing the functions again.
+*/
 void Adafruit_NeoPixel::setBrightnessFunctions(pBrightnessFunc fr, pBrightnessFunc fg, pBrightnessFunc fb, pBrightnessFunc fw) {
 	
-	if (opixels == NULL & numLEDs != 0) {
+	if (!scaleOnShow && opixels == NULL && numLEDs != 0) {
         opixels = (uint8_t *)malloc(numBytes);
 		memcpy(opixels,pixels,numBytes);
 	}
+	if (brightTable == NULL) {
+		brightTable = (uint8_t *)malloc(4 * 256);
+	}
 	
 	brightfr = fr;
 	brightfg = fg;
 	brightfb = fb;
 	brightfw = fw;
 	
-	for (int i = 0 ; i < numLEDs ; i++) {
-		uint32_t pixel;
-		pixel = getPixelColor(i);
-		setPixelColor(i,pixel);
-	}
+	updateBrightnessFunctions();
 };
+
+/*!
+  @brief   Re-evaluate the installed brightness functions into the lookup
+           table and rescale every pixel from its original value. Costs
+           1024 function calls plus one table load per byte, or just the
+           function calls when scaling on show.
+*/
+void Adafruit_NeoPixel::updateBrightnessFunctions(void) {
+	if (brightfr == NULL) return;
+	dirtyEnd = numLEDs; // every pixel comes out different
+
+	if (brightTable == NULL) { // no table, fall back to the calls in setPixelColor()
+		for (int i = 0 ; i < numLEDs ; i++) {
+			setPixelColor(i, getPixelColor(i));
+		}
+		return;
+	}
+
+	// one 256 byte table per byte offset within a pixel, so the hot paths
+	// index by offset without caring which color sits there
+	for (int v = 0 ; v < 256 ; v++) {
+		if (wOffset != rOffset) brightTable[wOffset * 256 + v] = brightfw(v);
+		brightTable[rOffset * 256 + v] = brightfr(v);
+		brightTable[gOffset * 256 + v] = brightfg(v);
+		brightTable[bOffset * 256 + v] = brightfb(v);
+	}
+
+	if (opixels == NULL || scaleOnShow) return;
+	uint8_t bpp = (wOffset == rOffset) ? 3 : 4;
+	for (uint16_t i = 0 ; i < numBytes ; i += bpp) {
+		for (uint8_t o = 0 ; o < bpp ; o++) {
+			pixels[i + o] = brightTable[o * 256 + opixels[i + o]];
+		}
+	}
+}
+
+/*!
+  @brief   Choose where the brightness functions are applied. By default
+           the strip keeps the colors as set in a second buffer (opixels)
+           and stores scaled values in the pixel buffer. With scaling on
+           show only the colors as set are stored and the brightness table
+           is applied while the pixels are packed for transmission, which
+           halves pixel RAM and makes a brightness change (through
+           updateBrightnessFunctions()) rescale every pixel for the price
+           of rebuilding the table.
+  @param   on  true to scale on show, false for the default.
+  @return  false if the brightness table (or, when turning it off, the
+           copy of the colors as set) could not be allocated; the strip
+           then stays in its previous mode.
+  @note    With scaling on show getPixels() holds the unscaled colors.
+*/
+bool Adafruit_NeoPixel::setBrightnessOnShow(bool on) {
+	if (on == scaleOnShow) return true;
+
+	if (on) {
+		if (brightTable == NULL) brightTable = (uint8_t *)malloc(4 * 256);
+		if (brightTable == NULL) return false;
+		if (opixels != NULL) { // keep the colors as set, drop the scaled ones
+			memcpy(pixels, opixels, numBytes);
+			free(opixels);
+			opixels = NULL;
+		};
+		scaleOnShow = true;
+	} else {
+		if (staticBuffers) return false; // would need a heap copy of the pixels
+		if (brightfr != NULL && numLEDs != 0) {
+			// the colors as set move to opixels, the pixel buffer gets the scaled ones
+			if ((opixels = (uint8_t *)malloc(numBytes)) == NULL) return false;
+			memcpy(opixels, pixels, numBytes);
+		};
+		scaleOnShow = false;
+	};
+	updateBrightnessFunctions();
+	return true;
+}
 		
 
 
@@ -693,6 +1082,7 @@ uint8_t Adafruit_NeoPixel::getBrightness(void) const {
 */
 void Adafruit_NeoPixel::clear(void) {
   memset(pixels, 0, numBytes);
+  dirtyEnd = numLEDs;
 }
 
 // A 32-bit variant of gamma8() that applies the same function
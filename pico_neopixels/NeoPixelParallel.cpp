@@ -0,0 +1,225 @@
+/*!
+ * @file NeoPixelParallel.cpp
+ *
+ * Parallel output of up to 8 strips from one state machine. Every frame
+ * the lanes' pixel bytes are transposed into bit-planes, one byte per bit
+ * time with a bit per lane, and fed to ws2812parallel by DMA. The wire
+ * time of a frame is that of the longest lane alone.
+ *
+ */
+
+#include "NeoPixelParallel.hpp"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "NeoPixelLock.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// outputs owning each DMA channel, for the shared DMA_IRQ_0 handler
+static NeoPixelParallel *parallel_owner[NUM_DMA_CHANNELS] = {NULL};
+static bool parallel_irq_installed = false;
+static bool parallel_irq_enabled[NUM_CORES] = {false}; // per core NVIC
+
+/*!
+  @brief   Parallel output constructor. Nothing is claimed until begin()
+           or the first show().
+  @param   basePin   Pin of lane 0.
+  @param   numLanes  Number of lanes (and consecutive pins), 1 to 8.
+  @param   freq      Bit rate, 800000 or 400000.
+*/
+NeoPixelParallel::NeoPixelParallel(uint8_t basePin, uint8_t numLanes, uint32_t freq) :
+  basePin(basePin), lanes(numLanes > NEOPIXEL_PARALLEL_LANES ? NEOPIXEL_PARALLEL_LANES : numLanes),
+  freq(freq), pioStatus(NeoPixelPioStatus::Unclaimed), dmaChannel(-1), planes(NULL), planeBytes(0), dmaBusy(false) {
+  claim.sm = -1;
+  endTime = get_absolute_time();
+  for (int i = 0 ; i < NEOPIXEL_PARALLEL_LANES ; i++) strips[i] = NULL;
+}
+
+/*!
+  @brief   Wait for the last frame, then release the state machine, the
+           DMA channel and the plane buffer.
+*/
+NeoPixelParallel::~NeoPixelParallel() {
+  waitShowDone();
+  if (dmaChannel != -1) {
+    dma_channel_set_irq0_enabled(dmaChannel, false);
+    parallel_owner[dmaChannel] = NULL;
+    dma_channel_unclaim(dmaChannel);
+  }
+  NeoPixelPioRegistry::release(&ws2812parallel_program, claim);
+  free(planes);
+}
+
+/*!
+  @brief   Attach the strip whose pixels are sent on a lane.
+  @param   lane   0 to numLanes() - 1.
+  @param   strip  Strip holding the pixels, or NULL to send nothing.
+  @return  false if lane is out of range.
+*/
+bool NeoPixelParallel::setLane(uint8_t lane, Adafruit_NeoPixel *strip) {
+  if (lane >= lanes) return false;
+  strips[lane] = strip;
+  return true;
+}
+
+/*!
+  @brief   Claim a state machine, load the program and claim a DMA channel.
+           Called by the first show() if not done before.
+  @return  false if no state machine (with room for the program) is free,
+           see getPioStatus(). Without a DMA channel the planes are fed by the CPU.
+*/
+bool NeoPixelParallel::begin(void) {
+  if (claim.sm != -1) return true;
+  pioStatus = NeoPixelPioRegistry::claim(&ws2812parallel_program, claim);
+  if (pioStatus != NeoPixelPioStatus::Ok) return false;
+  PIO pio = claim.pio;
+  int sm = claim.sm;
+
+  ws2812parallel_program_init(pio, sm, claim.offset, basePin, lanes, freq);
+
+  dmaChannel = dma_claim_unused_channel(false);
+  if (dmaChannel != -1) {
+    dma_channel_config c = dma_channel_get_default_config(dmaChannel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(dmaChannel, &c, &pio->txf[sm], NULL, 0, false);
+
+    parallel_owner[dmaChannel] = this;
+    dma_channel_set_irq0_enabled(dmaChannel, true);
+    enableDmaIrq();
+  }
+  return true;
+}
+
+// Transpose all lanes into planes, growing the buffer when a lane got
+// longer. Returns the number of FIFO words to send.
+uint16_t NeoPixelParallel::encode(void) {
+  const uint8_t *src[NEOPIXEL_PARALLEL_LANES];
+  const uint8_t *table[NEOPIXEL_PARALLEL_LANES];
+  uint16_t len[NEOPIXEL_PARALLEL_LANES];
+  uint8_t bpp[NEOPIXEL_PARALLEL_LANES], pos[NEOPIXEL_PARALLEL_LANES];
+  uint16_t bytes = 0;
+
+  for (uint8_t n = 0 ; n < NEOPIXEL_PARALLEL_LANES ; n++) {
+    Adafruit_NeoPixel *s = (n < lanes) ? strips[n] : NULL;
+    src[n] = s ? s->getPixels() : NULL;
+    len[n] = src[n] ? s->getNumBytes() : 0;
+    table[n] = s ? s->showTable() : NULL;
+    bpp[n] = s ? s->bitsPerPixel() / 8 : 3;
+    pos[n] = 0;
+    if (len[n] > bytes) bytes = len[n];
+  }
+
+  if (bytes > planeBytes) {
+    uint32_t *p = (uint32_t *)realloc(planes, bytes * 2 * sizeof(uint32_t));
+    if (p == NULL) return 0;
+    planes = p;
+    planeBytes = bytes;
+  }
+
+  uint8_t a[NEOPIXEL_PARALLEL_LANES];
+  uint32_t *w = planes;
+  for (uint16_t j = 0 ; j < bytes ; j++, w += 2) {
+    for (uint8_t n = 0 ; n < NEOPIXEL_PARALLEL_LANES ; n++) {
+      if (j >= len[n]) { a[n] = 0; continue; }
+      uint8_t v = src[n][j];
+      // brightness tables are laid out by byte offset within a pixel
+      a[n] = table[n] ? table[n][pos[n] * 256 + v] : v;
+      if (++pos[n] == bpp[n]) pos[n] = 0;
+    }
+    transpose8(a, w);
+  }
+  return bytes * 2;
+}
+
+// Set endTime to when the last bit handed to the state machine leaves the
+// pins: the words still in the FIFO plus the one being shifted out, each
+// four bit times, counted whole so that the latch is never cut short.
+void NeoPixelParallel::markEndTime(void) {
+  uint32_t words = pio_sm_get_tx_fifo_level(claim.pio, claim.sm) + 1;
+  uint32_t bit_ns = 1000000000u / freq;
+  endTime = delayed_by_us(get_absolute_time(), (words * 4 * bit_ns + 999) / 1000);
+}
+
+// Block for what is left of the latch after the previous frame.
+void NeoPixelParallel::waitLatch(void) {
+  while (!canShow()) {
+    tight_loop_contents();
+  }
+}
+
+// Add the shared handler once, and enable DMA_IRQ_0 on each core that
+// claims a channel or starts a transfer, as Adafruit_NeoPixel does.
+void NeoPixelParallel::enableDmaIrq(void) {
+  uint core = get_core_num();
+  if (parallel_irq_enabled[core]) return;
+  {
+    NeoPixelLock lock;
+    if (!parallel_irq_installed) {
+      irq_add_shared_handler(DMA_IRQ_0, dmaIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+      parallel_irq_installed = true;
+    }
+  }
+  irq_set_enabled(DMA_IRQ_0, true);
+  parallel_irq_enabled[core] = true;
+}
+
+// Shared DMA_IRQ_0 handler: marks the outputs whose transfer has ended idle.
+void NeoPixelParallel::dmaIrqHandler(void) {
+  for (int ch = 0 ; ch < NUM_DMA_CHANNELS ; ch++) {
+    NeoPixelParallel *owner = parallel_owner[ch];
+    if (owner == NULL) continue;
+    {
+      // both cores may take the interrupt; only one acknowledges it
+      NeoPixelLock lock;
+      if (!dma_channel_get_irq0_status(ch)) continue;
+      dma_channel_acknowledge_irq0(ch);
+    }
+    owner->markEndTime();
+    owner->dmaBusy = false;
+  }
+}
+
+/*!
+  @brief   Start sending all lanes and return. Waits for the previous
+           frame to be handed over and latched first; the lanes' pixels
+           may be changed again as soon as this returns.
+*/
+void NeoPixelParallel::showAsync(void) {
+  if (!begin()) return;
+  waitShowDone();
+  // encode while the previous frame drains and latches
+  uint16_t words = encode();
+  if (words == 0) return;
+  waitLatch();
+  if (dmaChannel == -1) {
+    for (uint16_t i = 0 ; i < words ; i++) pio_sm_put_blocking(claim.pio, claim.sm, planes[i]);
+    markEndTime();
+    return;
+  }
+  enableDmaIrq();
+  dmaBusy = true;
+  dma_channel_transfer_from_buffer_now(dmaChannel, planes, words);
+}
+
+/*!
+  @brief   Block until the last frame has been handed to the state
+           machine.
+*/
+void NeoPixelParallel::waitShowDone(void) {
+  while (dmaBusy) {
+    tight_loop_contents();
+  }
+  __compiler_memory_barrier(); // endTime was written by the interrupt
+}
+
+/*!
+  @brief   Send all lanes and wait until done.
+*/
+void NeoPixelParallel::show(void) {
+  showAsync();
+  waitShowDone();
+}
@@ -0,0 +1,123 @@
+/*!
+ * @file NeoPixelPioRegistry.cpp
+ *
+ * Shared PIO resource registry, see NeoPixelPioRegistry.hpp. The table is
+ * a few fixed slots per pio, so claiming and releasing take constant time.
+ *
+ */
+
+#include "NeoPixelPioRegistry.hpp"
+#include "NeoPixelLock.hpp"
+
+namespace {
+
+struct ProgramSlot {
+  const pio_program_t *program; // NULL if the slot is free
+  uint8_t              offset;
+  uint8_t              users;   // state machines running the program
+};
+
+ProgramSlot slots[2][NEOPIXEL_PIO_PROGRAMS];
+
+PIO pioAt(uint index) {
+  return (index == 0) ? pio0 : pio1;
+}
+
+ProgramSlot *findSlot(uint index, const pio_program_t *program) {
+  for (int i = 0 ; i < NEOPIXEL_PIO_PROGRAMS ; i++)
+    if (slots[index][i].program == program) return &slots[index][i];
+  return NULL;
+}
+
+} // namespace
+
+/*!
+  @brief   Claim a state machine that runs program, loading the program if
+           needed. pio0 is tried before pio1.
+  @param   program  The PIO program.
+  @param   claim    Filled in on success; sm is -1 otherwise.
+  @return  NeoPixelPioStatus::Ok, or why nothing could be claimed.
+*/
+NeoPixelPioStatus NeoPixelPioRegistry::claim(const pio_program_t *program, NeoPixelPioClaim &claim) {
+  NeoPixelPioStatus status = NeoPixelPioStatus::NoStateMachine;
+  claim.sm = -1;
+
+  NeoPixelLock lock;
+  for (uint p = 0 ; p < 2 ; p++) {
+    PIO pio = pioAt(p);
+    ProgramSlot *slot = findSlot(p, program);
+    bool load = (slot == NULL);
+    if (load) {
+      slot = findSlot(p, NULL);
+      if (slot == NULL || !pio_can_add_program(pio, program)) {
+        // tell a full pio from one that only lacks room for the program
+        int sm = pio_claim_unused_sm(pio, false);
+        if (sm != -1) {
+          pio_sm_unclaim(pio, sm);
+          status = NeoPixelPioStatus::NoProgramSpace;
+        }
+        continue;
+      }
+    }
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm == -1) continue;
+    if (load) {
+      slot->program = program;
+      slot->offset = pio_add_program(pio, program);
+      slot->users = 0;
+    }
+    slot->users++;
+    claim.pio = pio;
+    claim.sm = sm;
+    claim.offset = slot->offset;
+    status = NeoPixelPioStatus::Ok;
+    break;
+  }
+  return status;
+}
+
+/*!
+  @brief   Stop and release a claimed state machine, and remove the
+           program once no state machine runs it any more.
+  @param   program  The program passed to claim().
+  @param   claim    The claim; sm is set to -1. Nothing happens if it
+                    already is.
+*/
+void NeoPixelPioRegistry::release(const pio_program_t *program, NeoPixelPioClaim &claim) {
+  if (claim.sm == -1) return;
+
+  {
+    NeoPixelLock lock;
+    uint p = pio_get_index(claim.pio);
+    pio_sm_set_enabled(claim.pio, claim.sm, false);
+    pio_sm_unclaim(claim.pio, claim.sm);
+    ProgramSlot *slot = findSlot(p, program);
+    if (slot != NULL && --slot->users == 0) {
+      pio_remove_program(claim.pio, program, slot->offset);
+      slot->program = NULL;
+    }
+  }
+  claim.sm = -1;
+}
+
+/*!
+  @brief   Number of state machines of a pio currently running a program.
+*/
+uint8_t NeoPixelPioRegistry::users(PIO pio, const pio_program_t *program) {
+  NeoPixelLock lock;
+  ProgramSlot *slot = findSlot(pio_get_index(pio), program);
+  return slot ? slot->users : 0;
+}
+
+/*!
+  @brief   Short description of a status, for debug output.
+*/
+const char *NeoPixelPioRegistry::statusName(NeoPixelPioStatus status) {
+  switch (status) {
+    case NeoPixelPioStatus::Unclaimed:      return "unclaimed";
+    case NeoPixelPioStatus::Ok:             return "ok";
+    case NeoPixelPioStatus::NoStateMachine: return "no free state machine";
+    case NeoPixelPioStatus::NoProgramSpace: return "no room for the program";
+  }
+  return "?";
+}
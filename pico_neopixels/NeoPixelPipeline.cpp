@@ -0,0 +1,128 @@
+/*!
+ * @file NeoPixelPipeline.cpp
+ *
+ * Render/transmit pipeline across the two RP2040 cores. Core 0 renders
+ * into the strip's pixel buffer as usual and calls submit(), which copies
+ * the finished frame into a free snapshot buffer and queues it. Core 1
+ * takes queued frames, packs and transmits them and hands the buffers
+ * back. Both sides sleep with wfe and wake each other with sev.
+ *
+ */
+
+#include "NeoPixelPipeline.hpp"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include <cstdlib>
+#include <cstring>
+
+// core 1 runs a single loop, so only one pipeline can own it
+static NeoPixelPipeline *core1_pipeline = NULL;
+
+/*!
+  @brief   Pipeline constructor. Nothing runs on core 1 until begin().
+  @param   strip  Strip whose frames are transmitted.
+*/
+NeoPixelPipeline::NeoPixelPipeline(Adafruit_NeoPixel &strip) :
+  strip(strip), running(false), busy(false) {
+  for (int i = 0 ; i < NEOPIXEL_PIPELINE_DEPTH ; i++) frames[i] = NULL;
+}
+
+/*!
+  @brief   Stop the pipeline and free the snapshot buffers.
+*/
+NeoPixelPipeline::~NeoPixelPipeline() {
+  end();
+  for (int i = 0 ; i < NEOPIXEL_PIPELINE_DEPTH ; i++) free(frames[i]);
+}
+
+/*!
+  @brief   Allocate the snapshot buffers and launch the transmit loop on
+           core 1, which must not be in use by anything else.
+  @return  true if the pipeline is running, false if core 1 is already
+           owned by a pipeline or the buffers could not be allocated.
+           submit() then falls back to a plain show().
+*/
+bool NeoPixelPipeline::begin(void) {
+  if (running) return true;
+  if (core1_pipeline != NULL) return false;
+
+  for (int i = 0 ; i < NEOPIXEL_PIPELINE_DEPTH ; i++) {
+    if (frames[i] == NULL) frames[i] = (uint8_t *)malloc(strip.getNumBytes());
+    if (frames[i] == NULL) return false;
+  }
+  for (int i = 0 ; i < NEOPIXEL_PIPELINE_DEPTH ; i++) freeFrames.push(frames[i]);
+
+  // claim the strip's hardware from here, so that core 0, which waits
+  // for the transfers in flush(), takes their DMA interrupts
+  strip.beginDma();
+  core1_pipeline = this;
+  running = true;
+  multicore_launch_core1(core1Entry);
+  return true;
+}
+
+/*!
+  @brief   Send the frames still queued, then stop core 1.
+*/
+void NeoPixelPipeline::end(void) {
+  if (!running) return;
+  flush();
+  running = false;
+  __sev();
+  multicore_reset_core1();
+  core1_pipeline = NULL;
+
+  // reclaim the buffers for a later begin()
+  uint8_t *frame;
+  while (freeFrames.pop(frame)) ;
+}
+
+/*!
+  @brief   Queue the current contents of the pixel buffer for transmission
+           and return. Rendering of the next frame may start right away;
+           this only waits when all snapshot buffers are still queued.
+*/
+void NeoPixelPipeline::submit(void) {
+  if (!running) {
+    strip.show();
+    return;
+  }
+  uint8_t *frame;
+  while (!freeFrames.pop(frame)) __wfe();
+  memcpy(frame, strip.getPixels(), strip.getNumBytes());
+  readyFrames.push(frame); // can't fail, there are only DEPTH buffers
+  __sev();
+}
+
+/*!
+  @brief   Wait until every submitted frame has been handed to the
+           hardware.
+*/
+void NeoPixelPipeline::flush(void) {
+  // core 1 raises busy before it takes a frame, so checking the queue
+  // first can't miss a frame in between the two
+  while (!readyFrames.empty() || busy) tight_loop_contents();
+  strip.waitShowDone();
+}
+
+void NeoPixelPipeline::core1Entry(void) {
+  core1_pipeline->core1Loop();
+}
+
+void NeoPixelPipeline::core1Loop(void) {
+  while (running) {
+    uint8_t *frame;
+    busy = true;
+    if (!readyFrames.pop(frame)) {
+      busy = false;
+      __wfe(); // until submit() or end() signal
+      continue;
+    }
+    // showAsync() packs the frame into the DMA staging buffer, so the
+    // snapshot is free again as soon as it returns
+    strip.showAsync(frame);
+    freeFrames.push(frame);
+    busy = false;
+    __sev();
+  }
+}
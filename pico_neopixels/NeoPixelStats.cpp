@@ -0,0 +1,100 @@
+/*!
+ * @file NeoPixelStats.cpp
+ *
+ * Frame-timing histograms, see NeoPixelStats.hpp. Compiles to nothing
+ * unless NEOPIXEL_STATS is defined.
+ *
+ */
+
+#include "NeoPixelStats.hpp"
+
+#ifdef NEOPIXEL_STATS
+
+#include "NeoPixelLock.hpp"
+#include <cstdio>
+#include <cstring>
+
+static NeoPixelHistogram stats[NEOPIXEL_STAT_COUNT]; // under NeoPixelLock
+
+static const char *const stats_names[NEOPIXEL_STAT_COUNT] = {
+  "render", "show", "transmit", "sleep", "period", "requested", "lateness"
+};
+
+/*!
+  @brief   Add a sample to a histogram.
+  @param   stat  Histogram to add to.
+  @param   us    Sample, in microseconds.
+*/
+void NeoPixelStats::record(NeoPixelStat stat, uint32_t us) {
+  // bucket = number of significant bits
+  unsigned b = us ? 32 - __builtin_clz(us) : 0;
+  if (b >= NEOPIXEL_STATS_BUCKETS) b = NEOPIXEL_STATS_BUCKETS - 1;
+
+  NeoPixelLock lock;
+  NeoPixelHistogram &h = stats[stat];
+  if (h.count == 0 || us < h.min) h.min = us;
+  if (us > h.max) h.max = us;
+  h.count++;
+  h.sum += us;
+  h.buckets[b]++;
+}
+
+/*!
+  @brief   Copy a histogram.
+  @param   stat  Histogram to read.
+  @param   out   Receives a consistent snapshot of it.
+*/
+void NeoPixelStats::get(NeoPixelStat stat, NeoPixelHistogram &out) {
+  NeoPixelLock lock;
+  out = stats[stat];
+}
+
+/*!
+  @brief   Sum of all samples of a histogram, e.g. to find how much of an
+           interval was spent in show().
+*/
+uint64_t NeoPixelStats::total(NeoPixelStat stat) {
+  NeoPixelLock lock;
+  return stats[stat].sum;
+}
+
+/*!
+  @brief   Empty all histograms.
+*/
+void NeoPixelStats::reset(void) {
+  NeoPixelLock lock;
+  memset(stats, 0, sizeof(stats));
+}
+
+/*!
+  @brief   Name of a histogram, as used in the CSV header.
+*/
+const char *NeoPixelStats::name(NeoPixelStat stat) {
+  return (stat < NEOPIXEL_STAT_COUNT) ? stats_names[stat] : "?";
+}
+
+/*!
+  @brief   Print all histograms over stdio as CSV, one row per histogram:
+           name, count, min, mean, max and the bucket counts. The header
+           row gives each bucket's lower bound in us.
+*/
+void NeoPixelStats::dumpCSV(void) {
+  printf("stat,count,min,mean,max");
+  for (int b = 0 ; b < NEOPIXEL_STATS_BUCKETS ; b++)
+    printf(",%lu", b ? 1UL << (b - 1) : 0UL);
+  printf("\n");
+
+  for (int s = 0 ; s < NEOPIXEL_STAT_COUNT ; s++) {
+    NeoPixelHistogram h;
+    get((NeoPixelStat)s, h);
+    printf("%s,%lu,%lu,%lu,%lu", stats_names[s], (unsigned long)h.count,
+           (unsigned long)h.min,
+           (unsigned long)(h.count ? h.sum / h.count : 0),
+           (unsigned long)h.max);
+    for (int b = 0 ; b < NEOPIXEL_STATS_BUCKETS ; b++)
+      printf(",%lu", (unsigned long)h.buckets[b]);
+    printf("\n");
+  }
+}
+
+#endif // NEOPIXEL_STATS
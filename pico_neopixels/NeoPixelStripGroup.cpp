@@ -0,0 +1,90 @@
+/*!
+ * @file NeoPixelStripGroup.cpp
+ *
+ * Concurrent show() over several strips, see NeoPixelStripGroup.hpp.
+ *
+ */
+
+#include "NeoPixelStripGroup.hpp"
+
+/*!
+  @brief   Empty group.
+*/
+NeoPixelStripGroup::NeoPixelStripGroup(void) :
+  count(0), timing(false), startUs(0), lastUs(0), maxUs(0), frames(0), totalUs(0) {
+}
+
+/*!
+  @brief   Add a strip to the group, claiming its state machine and DMA
+           channel.
+  @return  false if the group already holds NEOPIXEL_GROUP_MAX_STRIPS, or
+           if the strip can't be sent by DMA: the CPU would hold up every
+           other strip while it sends it.
+*/
+bool NeoPixelStripGroup::add(Adafruit_NeoPixel &strip) {
+  if (count >= NEOPIXEL_GROUP_MAX_STRIPS) return false;
+  if (!strip.beginDma()) return false;
+  strips[count++] = &strip;
+  return true;
+}
+
+/*!
+  @brief   Start transmitting every strip and return, once the pixels of
+           all of them have latched the previous frame.
+*/
+void NeoPixelStripGroup::showAsync(void) {
+  // a frame still in flight is finished (and timed) first
+  waitShowDone();
+  // wait for the strip that latches last, so that no strip's own wait
+  // holds up the transfers after it
+  absolute_time_t latch = get_absolute_time();
+  for (uint8_t i = 0 ; i < count ; i++) {
+    absolute_time_t t = strips[i]->latchTime();
+    if (absolute_time_diff_us(latch, t) > 0) latch = t;
+  }
+  while (absolute_time_diff_us(get_absolute_time(), latch) > 0) {
+    tight_loop_contents();
+  }
+  startUs = time_us_64();
+  timing = true;
+  for (uint8_t i = 0 ; i < count ; i++) strips[i]->showAsync();
+}
+
+/*!
+  @brief   Check whether every strip's transfer has ended.
+*/
+bool NeoPixelStripGroup::isShowDone(void) const {
+  for (uint8_t i = 0 ; i < count ; i++)
+    if (!strips[i]->isShowDone()) return false;
+  return true;
+}
+
+/*!
+  @brief   Wait for all transfers of the last showAsync() and record the
+           frame time.
+*/
+void NeoPixelStripGroup::waitShowDone(void) {
+  for (uint8_t i = 0 ; i < count ; i++) strips[i]->waitShowDone();
+  if (!timing) return;
+  timing = false;
+  lastUs = (uint32_t)(time_us_64() - startUs);
+  if (lastUs > maxUs) maxUs = lastUs;
+  totalUs += lastUs;
+  frames++;
+}
+
+/*!
+  @brief   Transmit every strip and wait until all are sent.
+*/
+void NeoPixelStripGroup::show(void) {
+  showAsync();
+  waitShowDone();
+}
+
+/*!
+  @brief   Clear the frame time statistics.
+*/
+void NeoPixelStripGroup::resetFrameTimes(void) {
+  lastUs = maxUs = frames = 0;
+  totalUs = 0;
+}
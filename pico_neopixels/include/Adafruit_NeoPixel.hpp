@@ -39,6 +39,11 @@
 #include "hardware/pio.h"
 #include "pico/time.h"
 #include "ws2812byte.pio.h"
+#include "NeoPixelPioRegistry.hpp"
+
+#ifndef NEOPIXEL_LATCH_US
+#define NEOPIXEL_LATCH_US 300 ///< quiet time before the pixels latch a frame
+#endif
 
 
 
@@ -120,6 +125,9 @@
 
 typedef uint16_t neoPixelType; ///< 3rd arg to Adafruit_NeoPixel constructor
 typedef uint8_t (* pBrightnessFunc)(uint8_t value) ; // pointer to a brigness conversion function
+class Adafruit_NeoPixel;
+template <uint16_t Length, uint8_t BytesPerPixel> struct NeoPixelStaticBuffers;
+typedef void (* pShowCompleteFunc)(Adafruit_NeoPixel *strip, void *context) ; // called when an asynchronous show() has been sent
 
 // These two tables are declared outside the Adafruit_NeoPixel class
 // because some boards may require oldschool compilers that don't
@@ -176,11 +184,6 @@ static const uint8_t _NeoPixelGammaTable[256] = {
   182,184,186,188,191,193,195,197,199,202,204,206,209,211,213,215,
   218,220,223,225,227,230,232,235,237,240,242,245,247,250,252,255};
 
-// gloal hardware resource variables keeping track of configurations an usage on the pi Pico RP2040. 
-static int pio0_offset = -1;   		// offset of loaded pio neopixel program on pio0; -1 if no program loaded
-static int pio1_offset = -1;		// offset of loaded pio neopixel program on pio1; -1 if no program loaded
-static int pio_no_sm[2] = {0,0} ;	// number of state machines in use for Neopixel  
-
 static uint8_t  neopixels_gamma8(uint8_t x) {
     return _NeoPixelGammaTable[x]; // 0-255 in, 0-255 out
   }
@@ -196,12 +199,45 @@ class Adafruit_NeoPixel {
   // Constructor: number of LEDs, pin number, LED type
   Adafruit_NeoPixel(uint16_t n, uint16_t pin=0,
     neoPixelType type=NEO_GRB + NEO_KHZ800);
+  // Constructor with caller-provided buffers
+  Adafruit_NeoPixel(uint16_t n, uint16_t pin, neoPixelType type,
+    uint8_t *pixelBuffer, uint16_t pixelBytes, uint32_t *fifoBuffer, uint8_t *tableBuffer=NULL);
+  // Constructor on a NeoPixelStaticBuffers, for its whole length
+  template <uint16_t Length, uint8_t BytesPerPixel>
+  Adafruit_NeoPixel(uint16_t pin, neoPixelType type,
+    NeoPixelStaticBuffers<Length, BytesPerPixel> &buffers);
   Adafruit_NeoPixel(void);
   ~Adafruit_NeoPixel();
 
   void              begin(void);
+  bool              beginDma(void);
   void              show(void);
+  void              showAsync(void);
+  void              showAsync(const uint8_t *frame);
+  void              showChanged(void);
+  /*!
+    @brief   Mark pixels as changed for showChanged(), for code that writes
+             to getPixels() directly. setPixelColor(), fill() and clear()
+             do this themselves.
+    @param   end  One past the highest changed pixel index; the whole strip
+                  if unspecified.
+  */
+  void              markDirty(uint16_t end=0xFFFF) {
+    if (end > numLEDs) end = numLEDs;
+    if (end > dirtyEnd) dirtyEnd = end;
+  }
+  /*!
+    @brief   Check whether the last showAsync() transfer has been handed
+             completely to the PIO state machine.
+    @return  true if no transfer is in progress and the pixel buffer may be
+             changed without affecting the data being sent.
+  */
+  bool              isShowDone(void) const { return !dmaBusy; }
+  void              waitShowDone(void);
+  void              setShowCompleteCallback(pShowCompleteFunc f, void *context=NULL);
   void 				setBrightnessFunctions(pBrightnessFunc fr, pBrightnessFunc fg, pBrightnessFunc fb, pBrightnessFunc fw);
+  void              updateBrightnessFunctions(void);
+  bool              setBrightnessOnShow(bool on);
   void              setPin(uint16_t p);
   void              setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
   void              setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b,
@@ -224,10 +260,22 @@ class Adafruit_NeoPixel {
              concurrent task.
     @return  1 or true if show() will start sending immediately, 0 or false
              if show() would block (meaning some idle time is available).
+    @note    The quiet time is counted from when the last bit of the
+             previous frame leaves the pin, not from when show() or the
+             DMA transfer returned. A frame still being handed over by
+             showAsync() can't be followed yet either.
   */
-  bool canShow(void) {
+  bool canShow(void) const {
+    if (dmaBusy) return false;
     int64_t howlongago = absolute_time_diff_us (endTime, get_absolute_time());
-    return (howlongago >= 300L);
+    return (howlongago >= NEOPIXEL_LATCH_US);
+  }
+  /*!
+    @brief   Time from which the pixels have latched the previous frame,
+             so that canShow() holds once its transfer is done.
+  */
+  absolute_time_t   latchTime(void) const {
+    return delayed_by_us(endTime, NEOPIXEL_LATCH_US);
   }
   /*!
     @brief   Get a pointer directly to the NeoPixel data buffer in RAM.
@@ -255,7 +303,26 @@ class Adafruit_NeoPixel {
     @return  Pixel count (0 if not set).
   */
   uint16_t          numPixels(void) const { return numLEDs; }
+  /*!
+    @brief   Return the size of the pixel buffer returned by getPixels().
+    @return  Number of bytes, 3 or 4 per pixel.
+  */
+  uint16_t          getNumBytes(void) const { return numBytes; }
+  /*!
+    @brief   Return the pixel format, the byte offsets of each color within
+             a pixel as passed to updateType().
+    @return  NEO_* color order constant, without the NEO_KHZ400 flag.
+  */
+  neoPixelType      getType(void) const {
+    return (wOffset << 6) | (rOffset << 4) | (gOffset << 2) | bOffset;
+  }
   uint32_t          getPixelColor(uint16_t n) const;
+  /*!
+    @brief   Outcome of claiming a PIO state machine, done by the first
+             show(). Anything but Ok (or Unclaimed before the first show)
+             means the strip can't transmit.
+  */
+  NeoPixelPioStatus getPioStatus(void) const { return pioStatus; }
   /*!
     @brief   An 8-bit integer sine wave function, not directly compatible
              with standard trigonometric units like radians or degrees.
@@ -333,6 +400,47 @@ class Adafruit_NeoPixel {
   void rp2040Init(uint8_t pin) ;
   void rp2040Show(uint8_t pin, uint8_t *pixels, uint32_t numBytes, bool is800KHz);
   void rp2040changepin(uint8_t set_pin);
+  void rp2040ShowDMA(uint16_t n);
+  void startShow(const uint8_t *frame, uint16_t n, bool clean);
+  void markEndTime(void);
+  void waitLatch(void);
+  void packFifoWords(const uint8_t *pixels, uint16_t n);
+  /*!
+    @brief   Number of bits the state machine pulls per FIFO word: one
+             whole pixel, 24 for RGB or 32 for RGBW strips.
+  */
+  uint8_t bitsPerPixel(void) const { return (wOffset == rOffset) ? 24 : 32; }
+  /*!
+    @brief   Pack one pixel in wire order into a FIFO word, first byte
+             transmitted in the most significant byte.
+    @param   p    Pointer to the first byte of the pixel.
+    @param   bpp  Bytes per pixel, 3 or 4.
+  */
+  static uint32_t packPixel(const uint8_t *p, uint8_t bpp) {
+    uint32_t w = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8);
+    return (bpp == 4) ? (w | p[3]) : w;
+  }
+  /*!
+    @brief   Pack one pixel like packPixel() while passing each byte
+             through a brightness table.
+    @param   p      Pointer to the first byte of the pixel.
+    @param   bpp    Bytes per pixel, 3 or 4.
+    @param   table  256 entries per byte offset within a pixel.
+  */
+  static uint32_t packPixel(const uint8_t *p, uint8_t bpp, const uint8_t *table) {
+    uint32_t w = ((uint32_t)table[p[0]] << 24) | ((uint32_t)table[256 + p[1]] << 16) |
+                 ((uint32_t)table[512 + p[2]] << 8);
+    return (bpp == 4) ? (w | table[768 + p[3]]) : w;
+  }
+  /*!
+    @brief   Brightness table to apply while packing, NULL if the pixel
+             buffer already holds the output values.
+  */
+  const uint8_t *showTable(void) const {
+    return (scaleOnShow && brightfr != NULL) ? brightTable : NULL;
+  }
+  static void rp2040DmaIrqHandler(void);
+  static void rp2040EnableDmaIrq(void);
 
  protected:
 
@@ -344,17 +452,61 @@ class Adafruit_NeoPixel {
   uint8_t           brightness; ///< Strip brightness 0-255 (stored as +1)
   uint8_t          *pixels;     ///< Holds LED color values (3 or 4 bytes each)
   uint8_t		   *opixels;	///< Hold originally set LED color values ( 3 or 4 bytes each)
+  uint32_t		   *fifoWords;	///< DMA staging buffer, one packed FIFO word per pixel
+  uint8_t		   *brightTable; ///< brightness function output, 256 entries per byte offset within a pixel
+  bool				scaleOnShow; ///< true to apply brightTable while packing for transmission instead of keeping opixels
+  bool				staticBuffers; ///< true if pixels and fifoWords were provided by the caller and are never freed
+  bool				staticTable; ///< true if brightTable was provided by the caller
+  uint16_t			bufferLEDs;	///< capacity of caller-provided buffers, in pixels
+  uint16_t			bufferBytes; ///< capacity of a caller-provided pixel buffer, in bytes
   uint8_t           rOffset;    ///< Red index within each 3- or 4-byte pixel
   uint8_t           gOffset;    ///< Index of green byte
   uint8_t           bOffset;    ///< Index of blue byte
   uint8_t           wOffset;    ///< Index of white (==rOffset if no white)
-  absolute_time_t   endTime;    ///< Latch timing reference
+  uint16_t          dirtyEnd;   ///< pixels 0 to dirtyEnd - 1 may have changed since the last show
+  absolute_time_t   endTime;    ///< When the last bit of the previous frame leaves the pin
   PIO				pio;		///< chosen pio for this object
   uint				sm;			///<chosen state machine for this object; -1 if not yet set or none available. 
+  uint				pioOffset;	///< offset of ws2812byte in the pio
+  NeoPixelPioStatus	pioStatus;	///< result of claiming the state machine
   pBrightnessFunc	brightfr,
 					brightfg,
 					brightfb,
 					brightfw;	/// pointer to user installed brightness function
+  int				dmaChannel;	///< DMA channel feeding the state machine; -1 if none could be claimed
+  volatile bool		dmaBusy;	///< true while a showAsync() transfer is in flight
+  pShowCompleteFunc	showDone;	///< user callback run from the DMA interrupt when a transfer ends
+  void			   *showDoneContext; ///< opaque pointer handed back to showDone
 
 };
 
+/*!
+    @brief  Storage for a strip of a fixed length that uses no heap:
+            declare one static and build the strip on it, e.g.
+            static NeoPixelStaticBuffers<300> buf;
+            Adafruit_NeoPixel strip(pin, NEO_GRB + NEO_KHZ800, buf);
+            RGBW strips need BytesPerPixel 4. A strip whose type doesn't
+            fit the buffer has no pixels.
+*/
+template <uint16_t Length, uint8_t BytesPerPixel = 3>
+struct NeoPixelStaticBuffers {
+  static_assert(BytesPerPixel == 3 || BytesPerPixel == 4, "pixels are 3 (RGB) or 4 (RGBW) bytes");
+
+  uint8_t  pixels[Length * BytesPerPixel]; ///< pixel buffer
+  uint32_t fifoWords[Length];              ///< DMA staging buffer
+  uint8_t  brightTable[4 * 256];           ///< brightness function table
+};
+
+/*!
+  @brief   NeoPixel constructor on static buffers, for a strip of their
+           full length. See the buffer constructor.
+  @param   pin      Pin which will drive the NeoPixel data in.
+  @param   type     Pixel type, as for the first constructor.
+  @param   buffers  Storage that outlives the strip.
+*/
+template <uint16_t Length, uint8_t BytesPerPixel>
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t pin, neoPixelType type,
+  NeoPixelStaticBuffers<Length, BytesPerPixel> &buffers) :
+  Adafruit_NeoPixel(Length, pin, type, buffers.pixels, sizeof(buffers.pixels),
+                    buffers.fifoWords, buffers.brightTable) {}
+
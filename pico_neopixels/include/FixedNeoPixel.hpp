@@ -0,0 +1,143 @@
+/*!
+ * @file FixedNeoPixel.hpp
+ *
+ * Strip whose pixel format and length are template parameters. The byte
+ * offsets are compile-time constants and the pixels live in a std::array,
+ * so setPixelColor()/getPixelColor() inline to plain loads and stores with
+ * no format or brightness branches. Transmission, brightness on show and
+ * the rest of the hardware handling are done by an Adafruit_NeoPixel,
+ * which stays the choice when the format is only known at run time. All
+ * buffers are members, so a strip declared static uses no heap.
+ *
+ */
+
+#pragma once
+#include "Adafruit_NeoPixel.hpp"
+#include <array>
+
+/*!
+    @brief  NeoPixel strip of a fixed type and length, e.g.
+            FixedNeoPixel<NEO_GRB + NEO_KHZ800, 300> strip(pin);
+    @note   The colors are stored as set. To dim the strip, install
+            brightness functions with base().setBrightnessFunctions(); they
+            are applied on show. setBrightness() does not apply.
+*/
+template <neoPixelType Type, uint16_t Length>
+class FixedNeoPixel {
+
+ public:
+
+  static constexpr uint8_t wOffset = (Type >> 6) & 0b11; ///< Index of white byte
+  static constexpr uint8_t rOffset = (Type >> 4) & 0b11; ///< Index of red byte
+  static constexpr uint8_t gOffset = (Type >> 2) & 0b11; ///< Index of green byte
+  static constexpr uint8_t bOffset =  Type       & 0b11; ///< Index of blue byte
+  static constexpr uint8_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4; ///< 3 (RGB) or 4 (RGBW)
+
+  /*!
+    @brief   Strip on a given pin. Nothing is sent before begin().
+  */
+  explicit FixedNeoPixel(uint16_t pin) :
+    strip(Length, pin, Type, pixels.data(), pixels.size(), fifoWords, brightTable) {
+    // Adafruit_NeoPixel counts the pixel buffer in a uint16_t
+    static_assert((uint32_t)Length * bytesPerPixel <= 65535, "FixedNeoPixel: Length too long for its type");
+  }
+
+  /*!
+    @brief   Set up the pin, state machine and DMA.
+  */
+  void begin(void) { strip.begin(); }
+
+  /*!
+    @brief   Transmit the pixels and wait until they are sent.
+  */
+  void show(void) { strip.show(); }
+
+  /*!
+    @brief   Start transmitting the pixels and return. They are copied into
+             the DMA staging buffer first, so they may be changed at once.
+  */
+  void showAsync(void) { strip.showAsync(); }
+
+  /*!
+    @brief   Set a pixel's color from separate components.
+    @param   n  Pixel index, starting from 0. Out of range is ignored.
+  */
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) {
+    if (n >= Length) return;
+    uint8_t *p = &pixels[n * bytesPerPixel];
+    p[rOffset] = r;
+    p[gOffset] = g;
+    p[bOffset] = b;
+    if (bytesPerPixel == 4) p[wOffset] = w;
+  }
+
+  /*!
+    @brief   Set a pixel's color from a packed 32-bit (W)RGB value.
+    @param   n  Pixel index, starting from 0. Out of range is ignored.
+  */
+  void setPixelColor(uint16_t n, uint32_t c) {
+    setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c,
+                  (uint8_t)(c >> 24));
+  }
+
+  /*!
+    @brief   Query a pixel's color as a packed 32-bit (W)RGB value, 0 if
+             out of range.
+  */
+  uint32_t getPixelColor(uint16_t n) const {
+    if (n >= Length) return 0;
+    const uint8_t *p = &pixels[n * bytesPerPixel];
+    uint32_t c = (uint32_t)p[rOffset] << 16 | (uint32_t)p[gOffset] << 8 |
+                 p[bOffset];
+    if (bytesPerPixel == 4) c |= (uint32_t)p[wOffset] << 24;
+    return c;
+  }
+
+  /*!
+    @brief   Fill count pixels from first with a color; count 0 fills to
+             the end of the strip.
+  */
+  void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0) {
+    if (first >= Length) return;
+    uint16_t end = (count == 0 || count > Length - first) ? Length : first + count;
+    for (uint16_t i = first ; i < end ; i++) setPixelColor(i, c);
+  }
+
+  /*!
+    @brief   Set all pixels to off.
+  */
+  void clear(void) { pixels.fill(0); }
+
+  /*!
+    @brief   Number of pixels, known at compile time.
+  */
+  static constexpr uint16_t numPixels(void) { return Length; }
+
+  /*!
+    @brief   Direct access to the pixel data, in the device's byte order.
+  */
+  uint8_t *getPixels(void) { return pixels.data(); }
+
+  /*!
+    @brief   The Adafruit_NeoPixel that transmits the pixels, for brightness
+             functions, callbacks and the like. Its showChanged() doesn't
+             see the pixels set through this class.
+  */
+  Adafruit_NeoPixel &base(void) { return strip; }
+
+ private:
+
+  // strip points into this object's own buffers, so a copy would send
+  // (and a moved-from strip keep) pixels it doesn't own
+  FixedNeoPixel(const FixedNeoPixel &) = delete;
+  FixedNeoPixel(FixedNeoPixel &&) = delete;
+  FixedNeoPixel &operator=(const FixedNeoPixel &) = delete;
+  FixedNeoPixel &operator=(FixedNeoPixel &&) = delete;
+
+  // the buffers come first, as strip is handed them on construction
+  std::array<uint8_t, Length * bytesPerPixel> pixels{};
+  uint32_t          fifoWords[Length];
+  uint8_t           brightTable[4 * 256];
+  Adafruit_NeoPixel strip;
+
+};
@@ -0,0 +1,62 @@
+/*!
+ * @file NeoPixelFrameQueue.hpp
+ *
+ * Lock-free single-producer/single-consumer ring used to hand frame
+ * buffers between the two RP2040 cores. Only plain atomic loads and
+ * stores are used, which the Cortex-M0+ does without locking.
+ *
+ */
+
+#pragma once
+#include <atomic>
+
+/*!
+    @brief  Fixed size queue of N-1 items. push() may only be called from
+            one thread (core) and pop() from one other.
+*/
+template <typename T, unsigned N>
+class NeoPixelFrameQueue {
+
+ public:
+
+  /*!
+    @brief   Append an item.
+    @return  false if the queue is full.
+  */
+  bool push(const T &item) {
+    unsigned h = head.load(std::memory_order_relaxed);
+    unsigned next = (h + 1) % N;
+    if (next == tail.load(std::memory_order_acquire)) return false;
+    items[h] = item;
+    head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /*!
+    @brief   Take the oldest item.
+    @return  false if the queue is empty.
+  */
+  bool pop(T &item) {
+    unsigned t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    item = items[t];
+    tail.store((t + 1) % N, std::memory_order_release);
+    return true;
+  }
+
+  /*!
+    @brief   Check whether the queue holds no items. Only a snapshot when
+             the other side is active.
+  */
+  bool empty(void) const {
+    return head.load(std::memory_order_acquire) ==
+           tail.load(std::memory_order_acquire);
+  }
+
+ private:
+
+  T                     items[N];
+  std::atomic<unsigned> head{0}; ///< next slot to write, owned by the producer
+  std::atomic<unsigned> tail{0}; ///< next slot to read, owned by the consumer
+
+};
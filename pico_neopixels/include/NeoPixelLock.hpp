@@ -0,0 +1,53 @@
+/*!
+ * @file NeoPixelLock.hpp
+ *
+ * The lock guarding the library's shared tables, e.g. the PIO registry.
+ *
+ */
+
+#pragma once
+#include "hardware/sync.h"
+
+#ifndef NEOPIXEL_SPINLOCK_ID
+#define NEOPIXEL_SPINLOCK_ID PICO_SPINLOCK_ID_CLAIM_FREE_LAST ///< hardware spin lock taken by NeoPixelLock
+#endif
+
+/*!
+    @brief  Holds hardware spin lock NEOPIXEL_SPINLOCK_ID, with interrupts
+            off on this core, while in scope. The hardware lock needs no
+            initialisation, so it is safe from static constructors and
+            from the first use on either core. Keep the scope short and
+            never nest two.
+    @note   The default lock is the last of the claim-free range, which
+            spin_lock_claim_unused() hands out last. It is claimed the
+            first time it is held, so that it isn't handed out after. The
+            striped range is avoided: a critical section holding the same
+            lock while taking this one would deadlock.
+*/
+class NeoPixelLock {
+
+ public:
+
+  NeoPixelLock() : lock(spin_lock_instance(NEOPIXEL_SPINLOCK_ID)), saved(spin_lock_blocking(lock)) {
+    if (!claimed()) {
+      spin_lock_claim(NEOPIXEL_SPINLOCK_ID);
+      claimed() = true;
+    }
+  }
+  ~NeoPixelLock() { spin_unlock(lock, saved); }
+
+ private:
+
+  NeoPixelLock(const NeoPixelLock &) = delete;
+  NeoPixelLock &operator=(const NeoPixelLock &) = delete;
+
+  // set under the lock, once it is claimed
+  static bool &claimed(void) {
+    static bool c = false;
+    return c;
+  }
+
+  spin_lock_t      *lock;
+  uint32_t          saved;  ///< interrupt state to restore
+
+};
@@ -0,0 +1,108 @@
+/*!
+ * @file NeoPixelParallel.hpp
+ *
+ * Alternative output mode that drives up to 8 strips on consecutive pins
+ * from a single PIO state machine and DMA channel, see ws2812parallel.pio.
+ *
+ */
+
+#pragma once
+#include "Adafruit_NeoPixel.hpp"
+#include "ws2812parallel.pio.h"
+
+#define NEOPIXEL_PARALLEL_LANES 8 ///< strips one state machine can drive
+
+/*!
+    @brief  Sends the pixel buffers of up to 8 strips at once. The strips
+            (lanes) only hold the pixels, format and brightness: set their
+            colors as usual, but never show() them, as that would claim a
+            state machine of their own. Lane n is sent on pin basePin + n.
+            Lanes may differ in length and format; shorter ones are padded
+            with zero bits.
+*/
+class NeoPixelParallel {
+
+ public:
+
+  NeoPixelParallel(uint8_t basePin, uint8_t numLanes, uint32_t freq=800000);
+  ~NeoPixelParallel();
+
+  bool              setLane(uint8_t lane, Adafruit_NeoPixel *strip);
+  bool              begin(void);
+  void              show(void);
+  void              showAsync(void);
+  /*!
+    @brief   Check whether the last frame has been handed to the state
+             machine.
+  */
+  bool              isShowDone(void) const { return !dmaBusy; }
+  void              waitShowDone(void);
+  /*!
+    @brief   Check whether show() will start sending at once, rather than
+             wait for the pixels to latch the previous frame. The quiet
+             time is counted from when its last bit leaves the pins, as
+             for Adafruit_NeoPixel::canShow().
+  */
+  bool              canShow(void) const {
+    if (dmaBusy) return false;
+    return absolute_time_diff_us(endTime, get_absolute_time()) >= NEOPIXEL_LATCH_US;
+  }
+  /*!
+    @brief   Number of pins driven, basePin to basePin + numLanes() - 1.
+  */
+  uint8_t           numLanes(void) const { return lanes; }
+  /*!
+    @brief   Outcome of claiming the state machine in begin().
+  */
+  NeoPixelPioStatus getPioStatus(void) const { return pioStatus; }
+
+  /*!
+    @brief   Transpose one byte from each of 8 lanes into 8 bit-planes, in
+             the layout ws2812parallel expects. Plane i holds bit 7 - i
+             (the i-th bit sent) of every lane, lane n in bit n. Planes
+             0-3 go to planes[0], 4-7 to planes[1], first plane in the
+             least significant byte.
+    @param   a       One byte per lane, lane 0 first.
+    @param   planes  Two FIFO words.
+  */
+  static void transpose8(const uint8_t *a, uint32_t *planes) {
+    // Hacker's Delight transpose8, with lane 7 in the top row so that
+    // lane n ends up in bit n of each plane
+    uint32_t x = ((uint32_t)a[7] << 24) | ((uint32_t)a[6] << 16) | ((uint32_t)a[5] << 8) | a[4];
+    uint32_t y = ((uint32_t)a[3] << 24) | ((uint32_t)a[2] << 16) | ((uint32_t)a[1] << 8) | a[0];
+    uint32_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    // rows come out first plane in the top byte, the FIFO wants it low
+    planes[0] = __builtin_bswap32(t);
+    planes[1] = __builtin_bswap32(y);
+  }
+
+ private:
+
+  NeoPixelParallel(const NeoPixelParallel &) = delete;
+  NeoPixelParallel &operator=(const NeoPixelParallel &) = delete;
+
+  uint16_t          encode(void);
+  void              markEndTime(void);
+  void              waitLatch(void);
+  static void       dmaIrqHandler(void);
+  static void       enableDmaIrq(void);
+
+  Adafruit_NeoPixel *strips[NEOPIXEL_PARALLEL_LANES];
+  uint8_t           basePin;
+  uint8_t           lanes;
+  uint32_t          freq;
+  NeoPixelPioClaim  claim;       ///< state machine, sm -1 until claimed
+  NeoPixelPioStatus pioStatus;   ///< result of claiming it
+  int               dmaChannel;  ///< DMA channel feeding it, -1 if none
+  uint32_t         *planes;      ///< encoded bit-planes, two words per byte
+  uint16_t          planeBytes;  ///< bytes per lane planes has room for
+  absolute_time_t   endTime;     ///< when the last bit of the previous frame leaves the pins
+  volatile bool     dmaBusy;     ///< true while a showAsync() transfer is in flight
+
+};
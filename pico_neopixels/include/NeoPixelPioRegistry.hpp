@@ -0,0 +1,51 @@
+/*!
+ * @file NeoPixelPioRegistry.hpp
+ *
+ * Bookkeeping of the PIO programs and state machines used by all strips:
+ * a program is loaded into a pio the first time a state machine there
+ * needs it and removed when its last user is released.
+ *
+ */
+
+#pragma once
+#include "hardware/pio.h"
+
+#ifndef NEOPIXEL_PIO_PROGRAMS
+#define NEOPIXEL_PIO_PROGRAMS 2 ///< different programs tracked per pio
+#endif
+
+/*!
+    @brief  Outcome of NeoPixelPioRegistry::claim().
+*/
+enum class NeoPixelPioStatus : uint8_t {
+  Unclaimed,      ///< nothing claimed yet
+  Ok,             ///< state machine claimed, program loaded
+  NoStateMachine, ///< every state machine of both pios is in use
+  NoProgramSpace  ///< state machines are free, but not on a pio with room
+                  ///< for the program
+};
+
+/*!
+    @brief  A claimed state machine and where its program is loaded.
+*/
+struct NeoPixelPioClaim {
+  PIO  pio;    ///< pio the state machine belongs to
+  int  sm;     ///< state machine, -1 if none claimed
+  uint offset; ///< program offset within the pio's instruction memory
+};
+
+/*!
+    @brief  Claims and releases state machines together with the program
+            they run, keeping a reference count per loaded program. Safe to
+            call from both cores.
+*/
+class NeoPixelPioRegistry {
+
+ public:
+
+  static NeoPixelPioStatus claim(const pio_program_t *program, NeoPixelPioClaim &claim);
+  static void              release(const pio_program_t *program, NeoPixelPioClaim &claim);
+  static uint8_t           users(PIO pio, const pio_program_t *program);
+  static const char       *statusName(NeoPixelPioStatus status);
+
+};
@@ -0,0 +1,50 @@
+/*!
+ * @file NeoPixelPipeline.hpp
+ *
+ * Opt-in render/transmit pipeline: core 0 keeps rendering into the strip's
+ * pixel buffer while core 1 ships the previous frame.
+ *
+ */
+
+#pragma once
+#include "Adafruit_NeoPixel.hpp"
+#include "NeoPixelFrameQueue.hpp"
+
+#ifndef NEOPIXEL_PIPELINE_DEPTH
+#define NEOPIXEL_PIPELINE_DEPTH 2 ///< frames that may be queued or in flight
+#endif
+
+/*!
+    @brief  Hands snapshots of a strip's pixel buffer to core 1, which
+            transmits them while core 0 renders the next frame. Only one
+            pipeline can run at a time, as it owns core 1.
+*/
+class NeoPixelPipeline {
+
+ public:
+
+  NeoPixelPipeline(Adafruit_NeoPixel &strip);
+  ~NeoPixelPipeline();
+
+  bool              begin(void);
+  void              end(void);
+  void              submit(void);
+  void              flush(void);
+
+ private:
+
+  NeoPixelPipeline(const NeoPixelPipeline &) = delete;
+  NeoPixelPipeline &operator=(const NeoPixelPipeline &) = delete;
+
+  static void       core1Entry(void);
+  void              core1Loop(void);
+
+  Adafruit_NeoPixel &strip;
+  uint8_t          *frames[NEOPIXEL_PIPELINE_DEPTH]; ///< snapshot buffers
+  NeoPixelFrameQueue<uint8_t *, NEOPIXEL_PIPELINE_DEPTH + 1>
+                    readyFrames,  ///< core 0 -> core 1, frames to send
+                    freeFrames;   ///< core 1 -> core 0, frames sent
+  volatile bool     running;      ///< cleared to stop the core 1 loop
+  volatile bool     busy;         ///< true while core 1 holds a frame
+
+};
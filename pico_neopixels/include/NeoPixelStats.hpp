@@ -0,0 +1,76 @@
+/*!
+ * @file NeoPixelStats.hpp
+ *
+ * Optional frame-timing instrumentation. Build with NEOPIXEL_STATS defined
+ * (e.g. target_compile_definitions(app PRIVATE NEOPIXEL_STATS)) to collect
+ * how long frames take to render, show and transmit, and how well the
+ * requested frame period is kept. Without it the hooks below expand to
+ * nothing and NeoPixelStats is not declared.
+ *
+ */
+
+#pragma once
+#include "pico/stdlib.h"
+
+#ifdef NEOPIXEL_STATS
+
+#ifndef NEOPIXEL_STATS_BUCKETS
+#define NEOPIXEL_STATS_BUCKETS 24 ///< power of two buckets, 0 us to 2^22 us and over
+#endif
+
+/*!
+    @brief  Quantities that are measured, each into its own histogram.
+            All in microseconds.
+*/
+enum NeoPixelStat {
+  NEOPIXEL_STAT_RENDER,    ///< effect step, not counting show()
+  NEOPIXEL_STAT_SHOW,      ///< time show() blocked its caller
+  NEOPIXEL_STAT_TRANSMIT,  ///< pushing a frame into the PIO FIFO (CPU or DMA)
+  NEOPIXEL_STAT_SLEEP,     ///< sleeping between frames
+  NEOPIXEL_STAT_PERIOD,    ///< achieved time between two frames
+  NEOPIXEL_STAT_REQUESTED, ///< period the effect asked for
+  NEOPIXEL_STAT_LATENESS,  ///< how late a frame started after it was due
+  NEOPIXEL_STAT_COUNT
+};
+
+/*!
+    @brief  Fixed size histogram of one NeoPixelStat. Bucket 0 counts 0 us,
+            bucket k > 0 counts values from 2^(k-1) to 2^k - 1 us, the last
+            bucket everything above.
+*/
+struct NeoPixelHistogram {
+  uint32_t count;                           ///< samples recorded
+  uint64_t sum;                             ///< total of all samples
+  uint32_t min;                             ///< smallest sample
+  uint32_t max;                             ///< largest sample
+  uint32_t buckets[NEOPIXEL_STATS_BUCKETS]; ///< samples per bucket
+};
+
+/*!
+    @brief  Collects the histograms. Safe to record from both cores and
+            from interrupts.
+*/
+class NeoPixelStats {
+
+ public:
+
+  static void       record(NeoPixelStat stat, uint32_t us);
+  static void       get(NeoPixelStat stat, NeoPixelHistogram &out);
+  static uint64_t   total(NeoPixelStat stat);
+  static void       reset(void);
+  static void       dumpCSV(void);
+  static const char *name(NeoPixelStat stat);
+
+};
+
+#define NEOPIXEL_STATS_START(t)         uint32_t t = time_us_32()
+#define NEOPIXEL_STATS_STOP(stat, t)    NeoPixelStats::record(stat, time_us_32() - (t))
+#define NEOPIXEL_STATS_RECORD(stat, us) NeoPixelStats::record(stat, us)
+
+#else
+
+#define NEOPIXEL_STATS_START(t)
+#define NEOPIXEL_STATS_STOP(stat, t)
+#define NEOPIXEL_STATS_RECORD(stat, us)
+
+#endif
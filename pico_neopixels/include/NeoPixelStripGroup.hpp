@@ -0,0 +1,68 @@
+/*!
+ * @file NeoPixelStripGroup.hpp
+ *
+ * Shows several strips at once. Each strip keeps its own state machine and
+ * DMA channel; the group waits once for all of them to latch, starts their
+ * transfers back to back and then waits once more, so a frame takes as
+ * long as the longest strip instead of the sum of all of them.
+ *
+ */
+
+#pragma once
+#include "Adafruit_NeoPixel.hpp"
+
+#ifndef NEOPIXEL_GROUP_MAX_STRIPS
+#define NEOPIXEL_GROUP_MAX_STRIPS 8 ///< strips one group can hold
+#endif
+
+/*!
+    @brief  Set of strips that are shown together. The strips are not
+            copied and must outlive the group.
+*/
+class NeoPixelStripGroup {
+
+ public:
+
+  NeoPixelStripGroup(void);
+
+  bool              add(Adafruit_NeoPixel &strip);
+  /*!
+    @brief   Number of strips in the group.
+  */
+  uint8_t           size(void) const { return count; }
+  void              show(void);
+  void              showAsync(void);
+  bool              isShowDone(void) const;
+  void              waitShowDone(void);
+
+  /*!
+    @brief   Time the last frame took, from starting the first transfer to
+             the end of the last one, in microseconds.
+  */
+  uint32_t          lastFrameTime(void) const { return lastUs; }
+  /*!
+    @brief   Longest frame time since resetFrameTimes(), in microseconds.
+  */
+  uint32_t          maxFrameTime(void) const { return maxUs; }
+  /*!
+    @brief   Mean frame time since resetFrameTimes(), in microseconds.
+  */
+  uint32_t          averageFrameTime(void) const {
+    return frames ? (uint32_t)(totalUs / frames) : 0;
+  }
+  /*!
+    @brief   Number of frames timed since resetFrameTimes().
+  */
+  uint32_t          frameCount(void) const { return frames; }
+  void              resetFrameTimes(void);
+
+ private:
+
+  Adafruit_NeoPixel *strips[NEOPIXEL_GROUP_MAX_STRIPS];
+  uint8_t           count;
+  bool              timing;  ///< true while a frame started by showAsync() is untimed
+  uint64_t          startUs; ///< when the frame being timed started
+  uint32_t          lastUs, maxUs, frames;
+  uint64_t          totalUs;
+
+};
@@ -0,0 +1,71 @@
+/*!
+ * @file NeoPixelBench.hpp
+ *
+ * Minimal benchmark harness for the host build. A BENCH() registers
+ * itself and times its candidates with the host's real clock, not the
+ * fake one the stub SDK runs on. The numbers compare implementations on
+ * the same machine; they are not RP2040 cycle counts.
+ *
+ */
+
+#pragma once
+#include "NeoPixelHost.hpp"
+#include <chrono>
+#include <stdint.h>
+
+/*!
+    @brief  Times candidates and prints the cost of one operation each.
+*/
+class NeoPixelBench {
+
+ public:
+
+  /*!
+    @brief   Call f until it has run for at least 50 ms and print the mean
+             time per operation.
+    @param   label  What is timed.
+    @param   ops    Operations one call of f does.
+    @param   f      The candidate.
+  */
+  template <typename F>
+  void measure(const char *label, uint32_t ops, F f) {
+    uint64_t calls = 1;
+    double ns;
+    for (;;) {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (uint64_t i = 0 ; i < calls ; i++) f();
+      ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      if (ns >= 50e6) break;
+      calls *= 2;
+    }
+    report(label, ns / ((double)calls * ops));
+  }
+
+  /*!
+    @brief   Keep the compiler from dropping a result nothing else reads.
+  */
+  static void keep(uint32_t v) { sink = sink + v; }
+
+ private:
+
+  void report(const char *label, double nsPerOp);
+
+  static volatile uint32_t sink;
+
+};
+
+/*!
+    @brief  A registered benchmark, see BENCH().
+*/
+struct NeoPixelBenchCase {
+  NeoPixelBenchCase(const char *name, void (*run)(NeoPixelBench &));
+
+  const char        *name;
+  void             (*run)(NeoPixelBench &);
+  NeoPixelBenchCase *next;
+};
+
+#define BENCH(name) \
+  static void name(NeoPixelBench &bench); \
+  static NeoPixelBenchCase name##_case(#name, name); \
+  static void name(NeoPixelBench &bench)
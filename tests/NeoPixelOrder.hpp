@@ -0,0 +1,43 @@
+/*!
+ * @file NeoPixelOrder.hpp
+ *
+ * Pixel orders for the parseOrder() test and benchmark, and the linear
+ * scan parseOrder() used to do.
+ *
+ */
+
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+    @brief  A permutation of n pixels: electrical index i shows visual
+            position (i * step) % n. step must be coprime to n.
+*/
+inline std::vector<int> neopixel_order_vector(uint16_t n, uint16_t step) {
+  std::vector<int> order(n);
+  for (uint16_t i = 0 ; i < n ; i++) order[i] = (uint32_t)i * step % n;
+  return order;
+}
+
+/*!
+    @brief  The same permutation as a NeoPixelStrip order string.
+*/
+inline std::string neopixel_order_string(uint16_t n, uint16_t step) {
+  std::string s;
+  for (int v : neopixel_order_vector(n, step)) s += std::to_string(v) + " ";
+  return s;
+}
+
+/*!
+    @brief  parseOrder() before the lookup table: the last electrical index
+            showing a visual position.
+*/
+inline uint16_t neopixel_order_scan(const std::vector<int> &order, uint16_t value) {
+  uint16_t j = 0;
+  for (size_t i = 0 ; i < order.size() ; i++) {
+    if (order[i] == value) j = i;
+  }
+  return j;
+}
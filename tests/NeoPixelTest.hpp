@@ -0,0 +1,40 @@
+/*!
+ * @file NeoPixelTest.hpp
+ *
+ * Minimal test harness for the host build. A TEST() registers itself; the
+ * runner checks after each one that it left no state machine, program or
+ * DMA channel claimed.
+ *
+ */
+
+#pragma once
+#include "NeoPixelHost.hpp"
+#include <stdint.h>
+
+/*!
+    @brief  A registered test, see TEST().
+*/
+struct NeoPixelTestCase {
+  NeoPixelTestCase(const char *name, void (*run)(void));
+
+  const char       *name;
+  void            (*run)(void);
+  NeoPixelTestCase *next;
+};
+
+void neopixel_test_fail(const char *file, int line, const char *expr);
+void neopixel_test_fail_eq(const char *file, int line, const char *expr, long long a, long long b);
+
+#define TEST(name) \
+  static void name(void); \
+  static NeoPixelTestCase name##_case(#name, name); \
+  static void name(void)
+
+#define CHECK(cond) \
+  do { if (!(cond)) neopixel_test_fail(__FILE__, __LINE__, #cond); } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    long long a_ = (long long)(a), b_ = (long long)(b); \
+    if (a_ != b_) neopixel_test_fail_eq(__FILE__, __LINE__, #a " == " #b, a_, b_); \
+  } while (0)
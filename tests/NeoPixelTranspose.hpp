@@ -0,0 +1,21 @@
+/*!
+ * @file NeoPixelTranspose.hpp
+ *
+ * The bit by bit transpose NeoPixelParallel::transpose8() is checked and
+ * timed against.
+ *
+ */
+
+#pragma once
+#include <stdint.h>
+
+/*!
+    @brief  Plane i holds bit 7 - i of every lane, lane n in bit n, planes
+            0-3 in planes[0] from the least significant byte up.
+*/
+inline void neopixel_transpose8_reference(const uint8_t *a, uint32_t *planes) {
+  planes[0] = planes[1] = 0;
+  for (int i = 0 ; i < 8 ; i++)
+    for (int n = 0 ; n < 8 ; n++)
+      if (a[n] & (0x80 >> i)) planes[i / 4] |= 1u << ((i % 4) * 8 + n);
+}
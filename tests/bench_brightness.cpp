@@ -0,0 +1,59 @@
+/*!
+ * @file bench_brightness.cpp
+ *
+ * Scaling pixels through the brightness table against a call of the
+ * brightness function per channel, as the inner loop and as the whole of
+ * setPixelColor(), and rescaling a whole strip.
+ *
+ */
+
+#include "NeoPixelBench.hpp"
+#include "Adafruit_NeoPixel.hpp"
+
+static uint8_t level = 160;
+static uint8_t scale(uint8_t v) { return (uint16_t)v * level / 255; }
+
+// what setPixelColor() did before the table: an indirect call per channel
+static void setPixelCalls(uint8_t *pixels, uint16_t n, uint32_t c, pBrightnessFunc fr,
+                          pBrightnessFunc fg, pBrightnessFunc fb) {
+  uint8_t *p = &pixels[n * 3];
+  p[1] = fr((uint8_t)(c >> 16));
+  p[0] = fg((uint8_t)(c >> 8));
+  p[2] = fb((uint8_t)c);
+}
+
+// what it does now, one load per channel
+static void setPixelTable(uint8_t *pixels, uint16_t n, uint32_t c, const uint8_t *table) {
+  uint8_t *p = &pixels[n * 3];
+  p[1] = table[1 * 256 + (uint8_t)(c >> 16)];
+  p[0] = table[0 * 256 + (uint8_t)(c >> 8)];
+  p[2] = table[2 * 256 + (uint8_t)c];
+}
+
+BENCH(brightness_lut) {
+  const uint16_t n = 500;
+  Adafruit_NeoPixel strip(n, 2, NEO_GRB + NEO_KHZ800);
+  strip.setBrightnessFunctions(scale, scale, scale, scale);
+  static uint8_t pixels[n * 3], table[3 * 256];
+  for (int v = 0 ; v < 3 * 256 ; v++) table[v] = scale(v & 0xFF);
+  // volatile, so the calls stay indirect as they were
+  pBrightnessFunc volatile f = scale;
+
+  bench.measure("function calls, inner loop", n, [&]() {
+    for (uint16_t i = 0 ; i < n ; i++) setPixelCalls(pixels, i, i * 0x010203, f, f, f);
+    NeoPixelBench::keep(pixels[0]);
+  });
+  bench.measure("table, inner loop", n, [&]() {
+    for (uint16_t i = 0 ; i < n ; i++) setPixelTable(pixels, i, i * 0x010203, table);
+    NeoPixelBench::keep(pixels[0]);
+  });
+  bench.measure("table, setPixelColor()", n, [&]() {
+    for (uint16_t i = 0 ; i < n ; i++) strip.setPixelColor(i, i * 0x010203);
+    NeoPixelBench::keep(strip.getPixels()[0]);
+  });
+  bench.measure("table, rescale whole strip", 1, [&]() {
+    level ^= 1;
+    strip.updateBrightnessFunctions();
+    NeoPixelBench::keep(strip.getPixels()[0]);
+  });
+}
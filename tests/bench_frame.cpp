@@ -0,0 +1,41 @@
+/*!
+ * @file bench_frame.cpp
+ *
+ * Filling a 500 pixel strip through a FrameView against a parseOrder()
+ * and setPixelColor() call per pixel.
+ *
+ */
+
+#include "NeoPixelBench.hpp"
+#include "NeoPixelOrder.hpp"
+#include "pico_neopixel_animations.h"
+
+BENCH(frame_view) {
+  const uint16_t n = 500;
+  NeoPixelStrip np(n, 2, neopixel_order_string(n, 17));
+  // same type and length as np's own strip
+  Adafruit_NeoPixel strip(n, 3, NEO_GRB + NEO_KHZ800);
+  NeoPixelStrip::FrameView f = np.frame();
+  uint32_t c = 0;
+
+  bench.measure("setPixelColor(parseOrder(v)), whole strip", n, [&]() {
+    c++;
+    for (uint16_t v = 0 ; v < n ; v++) strip.setPixelColor(np.parseOrder(v), c + v);
+    NeoPixelBench::keep(strip.getPixels()[0]);
+  });
+  bench.measure("FrameView::set, whole strip", n, [&]() {
+    c++;
+    for (uint16_t v = 0 ; v < n ; v++) f.set(v, c + v);
+    NeoPixelBench::keep(f.get(0));
+  });
+  bench.measure("setPixelColor(parseOrder(v)), one color", n, [&]() {
+    c++;
+    for (uint16_t v = 0 ; v < n ; v++) strip.setPixelColor(np.parseOrder(v), c);
+    NeoPixelBench::keep(strip.getPixels()[0]);
+  });
+  bench.measure("FrameView::fill_range, one color", n, [&]() {
+    c++;
+    f.fill_range(0, n, c);
+    NeoPixelBench::keep(f.get(0));
+  });
+}
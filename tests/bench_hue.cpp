@@ -0,0 +1,47 @@
+/*!
+ * @file bench_hue.cpp
+ *
+ * A rainbow along the strip, one hue per pixel: gamma32(ColorHSV()) per
+ * pixel against a hue table lookup and NeoPixelHuePhase, at 300 and 1000
+ * pixels.
+ *
+ */
+
+#include "NeoPixelBench.hpp"
+#include "pico_neopixel_hue.h"
+#include <cstdio>
+
+BENCH(hue_wheel) {
+  static uint32_t colors[1000];
+  const uint16_t sizes[] = {300, 1000};
+  uint16_t first = 0;
+  char label[64];
+
+  for (uint16_t n : sizes) {
+    snprintf(label, sizeof label, "gamma32(ColorHSV()), %u pixels", n);
+    bench.measure(label, n, [&]() {
+      first += 512;
+      for (uint16_t i = 0 ; i < n ; i++) {
+        uint16_t hue = first + (uint32_t)i * 65536 / n;
+        colors[i] = Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(hue));
+      }
+      NeoPixelBench::keep(colors[0]);
+    });
+    snprintf(label, sizeof label, "neopixelHueColor(), %u pixels", n);
+    bench.measure(label, n, [&]() {
+      first += 512;
+      for (uint16_t i = 0 ; i < n ; i++) colors[i] = neopixelHueColor(first + (uint32_t)i * 65536 / n);
+      NeoPixelBench::keep(colors[0]);
+    });
+    snprintf(label, sizeof label, "NeoPixelHuePhase, %u pixels", n);
+    bench.measure(label, n, [&]() {
+      first += 512;
+      NeoPixelHuePhase hue(first, 1, n);
+      for (uint16_t i = 0 ; i < n ; i++) {
+        colors[i] = hue.color();
+        hue.advance();
+      }
+      NeoPixelBench::keep(colors[0]);
+    });
+  }
+}
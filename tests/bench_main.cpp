@@ -0,0 +1,43 @@
+/*!
+ * @file bench_main.cpp
+ *
+ * Runs every BENCH(), or those whose name contains the first argument.
+ *
+ */
+
+#include "NeoPixelBench.hpp"
+#include <cstdio>
+#include <cstring>
+
+static NeoPixelBenchCase *benches = NULL;
+
+volatile uint32_t NeoPixelBench::sink = 0;
+
+NeoPixelBenchCase::NeoPixelBenchCase(const char *name, void (*run)(NeoPixelBench &)) :
+  name(name), run(run), next(benches) {
+  benches = this;
+}
+
+void NeoPixelBench::report(const char *label, double nsPerOp) {
+  printf("  %-44s %10.2f ns/op\n", label, nsPerOp);
+}
+
+int main(int argc, char **argv) {
+  // registered last first
+  NeoPixelBenchCase *order = NULL;
+  while (benches) {
+    NeoPixelBenchCase *b = benches;
+    benches = b->next;
+    b->next = order;
+    order = b;
+  }
+
+  NeoPixelBench bench;
+  for (NeoPixelBenchCase *b = order ; b ; b = b->next) {
+    if (argc > 1 && strstr(b->name, argv[1]) == NULL) continue;
+    printf("%s\n", b->name);
+    b->run(bench);
+    NeoPixelHost::settle();
+  }
+  return 0;
+}
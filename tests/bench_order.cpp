@@ -0,0 +1,28 @@
+/*!
+ * @file bench_order.cpp
+ *
+ * parseOrder() table lookup against the linear scan it replaced, on a
+ * 500 pixel strip.
+ *
+ */
+
+#include "NeoPixelBench.hpp"
+#include "NeoPixelOrder.hpp"
+#include "pico_neopixel_animations.h"
+
+BENCH(parse_order) {
+  const uint16_t n = 500;
+  NeoPixelStrip np(n, 2, neopixel_order_string(n, 17));
+  std::vector<int> order = neopixel_order_vector(n, 17);
+
+  bench.measure("linear scan, whole strip", n, [&]() {
+    uint32_t sum = 0;
+    for (uint16_t v = 0 ; v < n ; v++) sum += neopixel_order_scan(order, v);
+    NeoPixelBench::keep(sum);
+  });
+  bench.measure("table lookup, whole strip", n, [&]() {
+    uint32_t sum = 0;
+    for (uint16_t v = 0 ; v < n ; v++) sum += np.parseOrder(v);
+    NeoPixelBench::keep(sum);
+  });
+}
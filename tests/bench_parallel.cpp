@@ -0,0 +1,30 @@
+/*!
+ * @file bench_parallel.cpp
+ *
+ * NeoPixelParallel::transpose8() against the bit by bit transpose, over
+ * 8 lanes of 300 RGB pixels.
+ *
+ */
+
+#include "NeoPixelBench.hpp"
+#include "NeoPixelParallel.hpp"
+#include "NeoPixelTranspose.hpp"
+
+BENCH(parallel_transpose) {
+  const int bytes = 300 * 3;
+  static uint8_t lanes[bytes][8];
+  static uint32_t planes[bytes][2];
+  uint32_t x = 12345;
+  for (int i = 0 ; i < bytes ; i++) {
+    for (int n = 0 ; n < 8 ; n++) { x = x * 1103515245 + 12345; lanes[i][n] = x >> 16; }
+  }
+
+  bench.measure("bit by bit, per byte of 8 lanes", bytes, [&]() {
+    for (int i = 0 ; i < bytes ; i++) neopixel_transpose8_reference(lanes[i], planes[i]);
+    NeoPixelBench::keep(planes[bytes - 1][0]);
+  });
+  bench.measure("transpose8, per byte of 8 lanes", bytes, [&]() {
+    for (int i = 0 ; i < bytes ; i++) NeoPixelParallel::transpose8(lanes[i], planes[i]);
+    NeoPixelBench::keep(planes[bytes - 1][0]);
+  });
+}
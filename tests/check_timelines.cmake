@@ -0,0 +1,22 @@
+# Run with cmake -DPYTHON=<python3> -P from the source root: regenerates
+# each timelines/*.h from its .txt with tools/timeline2c.py and fails if
+# the checked-in header differs.
+
+file(GLOB sources RELATIVE ${CMAKE_CURRENT_SOURCE_DIR} timelines/*.txt)
+foreach (source ${sources})
+  string(REGEX REPLACE "\\.txt$" ".h" header ${source})
+  execute_process(
+    COMMAND ${PYTHON} tools/timeline2c.py ${source}
+    OUTPUT_VARIABLE generated
+    RESULT_VARIABLE result
+  )
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "tools/timeline2c.py failed on ${source}")
+  endif()
+  file(READ ${header} checked_in)
+  if (NOT generated STREQUAL checked_in)
+    message(FATAL_ERROR "${header} is out of date, regenerate it with\n"
+                        "  python3 tools/timeline2c.py ${source} > ${header}")
+  endif()
+  message(STATUS "${header} matches ${source}")
+endforeach()
@@ -0,0 +1,65 @@
+/*!
+ * @file main.cpp
+ *
+ * Runs every TEST(), or those whose name contains the first argument.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "hardware/pio.h"
+#include <cstdio>
+#include <cstring>
+
+static NeoPixelTestCase *tests = NULL;
+static int failures = 0;
+
+NeoPixelTestCase::NeoPixelTestCase(const char *name, void (*run)(void)) :
+  name(name), run(run), next(tests) {
+  tests = this;
+}
+
+void neopixel_test_fail(const char *file, int line, const char *expr) {
+  printf("%s:%d: CHECK(%s) failed\n", file, line, expr);
+  failures++;
+}
+
+void neopixel_test_fail_eq(const char *file, int line, const char *expr, long long a, long long b) {
+  printf("%s:%d: CHECK_EQ(%s) failed: %lld != %lld\n", file, line, expr, a, b);
+  failures++;
+}
+
+// whatever a test claimed it must have released
+static void checkReleased(void) {
+  CHECK_EQ(NeoPixelHost::freeStateMachines(pio0), NUM_PIO_STATE_MACHINES);
+  CHECK_EQ(NeoPixelHost::freeStateMachines(pio1), NUM_PIO_STATE_MACHINES);
+  CHECK_EQ(NeoPixelHost::freeInstructions(pio0), PIO_INSTRUCTION_COUNT);
+  CHECK_EQ(NeoPixelHost::freeInstructions(pio1), PIO_INSTRUCTION_COUNT);
+  CHECK_EQ(NeoPixelHost::claimedDmaChannels(), 0);
+}
+
+int main(int argc, char **argv) {
+  // registered last first
+  NeoPixelTestCase *order = NULL;
+  while (tests) {
+    NeoPixelTestCase *t = tests;
+    tests = t->next;
+    t->next = order;
+    order = t;
+  }
+
+  int run = 0, failed = 0;
+  for (NeoPixelTestCase *t = order ; t ; t = t->next) {
+    if (argc > 1 && strstr(t->name, argv[1]) == NULL) continue;
+    int before = failures;
+    NeoPixelHost::settle();
+    NeoPixelHost::clearPins();
+    t->run();
+    NeoPixelHost::settle();
+    checkReleased();
+    run++;
+    if (failures != before) failed++;
+    printf("%s %s\n", failures == before ? "[  OK  ]" : "[ FAIL ]", t->name);
+  }
+  printf("%d tests, %d failed\n", run, failed);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+/*!
+ * @file test_beat.cpp
+ *
+ * The beat grid on the fake clock: no drift however long frames take,
+ * overruns counted, and the timeline player reporting them.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_animations.h"
+#include "pico_neopixel_timeline.h"
+#include "pico/stdlib.h"
+
+TEST(beat_clock_does_not_drift_over_24_steps) {
+  NeoPixelBeatClock beat(116, 4); // 129310.34 us per tick
+  uint64_t origin = time_us_64();
+  beat.start(origin);
+  for (uint32_t tick = 1 ; tick <= 24 ; tick++) {
+    // render and show time that changes every frame
+    sleep_us(1000 + (tick * 7919) % 120000);
+    CHECK_EQ(beat.waitUntil(tick), 0);
+    CHECK_EQ(time_us_64(), origin + tick * 60000000ULL / 464);
+  }
+  // a sum of rounded ticks would be 24 * 129310 = 3103440
+  CHECK_EQ(time_us_64() - origin, 3103448);
+  CHECK_EQ(beat.overruns(), 0);
+}
+
+TEST(beat_clock_counts_overruns_without_shifting_the_grid) {
+  NeoPixelBeatClock beat(10000);
+  uint64_t origin = time_us_64();
+  beat.start(origin);
+  CHECK_EQ(beat.wait(), 0);
+  sleep_us(13000); // runs 3 ms into tick 2
+  CHECK_EQ(beat.wait(), 3000);
+  CHECK_EQ(time_us_64(), origin + 23000);
+  CHECK_EQ(beat.wait(), 0);
+  CHECK_EQ(time_us_64(), origin + 30000);
+  sleep_us(25000);
+  CHECK_EQ(beat.wait(), 15000);
+  CHECK_EQ(beat.overruns(), 2);
+  CHECK_EQ(beat.worstOverrun(), 15000);
+}
+
+static constexpr NeoPixelKeyframe close_keys[] = {
+  {0, 0, 0, NeoPixelKeyAction::Fill, NeoPixelEasing::Linear, 0x0000FF, 0},
+  {5000, 0, 0, NeoPixelKeyAction::Fill, NeoPixelEasing::Linear, 0x00FF00, 0},
+  {60000, 0, 0, NeoPixelKeyAction::Fill, NeoPixelEasing::Linear, 0xFF0000, 0},
+};
+
+TEST(timeline_player_reports_frames_running_past_a_keyframe) {
+  uint8_t saved = NeoPixelStrip::brightness;
+  NeoPixelStrip::brightness = 255;
+  NeoPixelStrip npStrip(500, 19);
+  NeoPixelTimelinePlayer player(npStrip, makeTimeline(close_keys));
+  uint64_t origin = time_us_64();
+  NeoPixelScheduler().run(&player);
+  // 500 pixels take 15 ms to send, the second keyframe was due after 5 ms;
+  // the third was far enough away
+  CHECK_EQ(player.beat().overruns(), 1);
+  CHECK(player.beat().worstOverrun() > 9000);
+  CHECK(player.beat().worstOverrun() < 11000);
+  // keyframes stay on the grid: the last one wasn't pushed back
+  CHECK(time_us_64() - origin < 60000 + 16000);
+  NeoPixelStrip::brightness = saved;
+}
@@ -0,0 +1,85 @@
+/*!
+ * @file test_brightness.cpp
+ *
+ * Brightness functions, applied to the buffer or on show.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "Adafruit_NeoPixel.hpp"
+#include <vector>
+
+static uint8_t half(uint8_t v) { return v / 2; }
+
+TEST(brightness_on_show_stays_on_when_copy_fails) {
+  Adafruit_NeoPixel strip(4, 2, NEO_GRB + NEO_KHZ800);
+  strip.setBrightnessFunctions(half, half, half, half);
+  CHECK(strip.setBrightnessOnShow(true));
+  strip.setPixelColor(0, 0xC8C8C8);
+
+  NeoPixelHost::failAllocations(1);
+  CHECK(!strip.setBrightnessOnShow(false));
+  // still scaling on show, with the colors as set in the buffer
+  CHECK(strip.showTable() != NULL);
+  CHECK_EQ(strip.getPixels()[0], 0xC8);
+  strip.show();
+  NeoPixelHost::settle();
+  CHECK_EQ(NeoPixelHost::pin(2).leds[0], 0x64);
+
+  // with memory the switch goes through and the buffer gets scaled
+  CHECK(strip.setBrightnessOnShow(false));
+  CHECK(strip.showTable() == NULL);
+  CHECK_EQ(strip.getPixels()[0], 0x64);
+  CHECK_EQ(strip.getPixelColor(0), 0xC8C8C8);
+}
+
+static uint8_t level = 255;
+static uint8_t scaleR(uint8_t v) { return (uint16_t)v * level / 255; }
+static uint8_t scaleG(uint8_t v) { return (uint16_t)v * v / 255 * level / 255; }
+static uint8_t scaleB(uint8_t v) { return 255 - v; }
+static uint8_t scaleW(uint8_t v) { return v / 3; }
+
+TEST(brightness_table_matches_the_functions) {
+  Adafruit_NeoPixel strip(256, 2, NEO_GRBW + NEO_KHZ800);
+  level = 200;
+  strip.setBrightnessFunctions(scaleR, scaleG, scaleB, scaleW);
+  for (int v = 0 ; v < 256 ; v++) strip.setPixelColor(v, v, 255 - v, v ^ 0x5A, v / 2);
+  // NEO_GRBW: G, R, B, W
+  const uint8_t *p = strip.getPixels();
+  for (int v = 0 ; v < 256 ; v++) {
+    CHECK_EQ(p[v * 4 + 0], scaleG(255 - v));
+    CHECK_EQ(p[v * 4 + 1], scaleR(v));
+    CHECK_EQ(p[v * 4 + 2], scaleB(v ^ 0x5A));
+    CHECK_EQ(p[v * 4 + 3], scaleW(v / 2));
+    CHECK_EQ(strip.getPixelColor(v), (uint32_t)(v / 2) << 24 | (uint32_t)v << 16 | (uint32_t)(255 - v) << 8 | (v ^ 0x5A));
+  }
+
+  // a new level rescales every pixel from the colors as set
+  level = 50;
+  strip.updateBrightnessFunctions();
+  for (int v = 0 ; v < 256 ; v++) {
+    CHECK_EQ(p[v * 4 + 0], scaleG(255 - v));
+    CHECK_EQ(p[v * 4 + 1], scaleR(v));
+  }
+}
+
+TEST(brightness_table_on_show_matches_the_functions) {
+  {
+    Adafruit_NeoPixel strip(16, 3, NEO_RGB + NEO_KHZ800);
+    level = 128;
+    strip.setBrightnessFunctions(scaleR, scaleG, scaleB, scaleW);
+    CHECK(strip.setBrightnessOnShow(true));
+    for (int i = 0 ; i < 16 ; i++) strip.setPixelColor(i, i * 16, i * 15, i * 7);
+    strip.show();
+    NeoPixelHost::settle();
+  }
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(3);
+  CHECK(!pin.frames.empty());
+  if (pin.frames.empty()) return;
+  const std::vector<uint8_t> &b = pin.frames[0].bytes;
+  for (int i = 0 ; i < 16 ; i++) {
+    CHECK_EQ(b[i * 3 + 0], scaleR(i * 16));
+    CHECK_EQ(b[i * 3 + 1], scaleG(i * 15));
+    CHECK_EQ(b[i * 3 + 2], scaleB(i * 7));
+  }
+}
@@ -0,0 +1,135 @@
+/*!
+ * @file test_dma.cpp
+ *
+ * showAsync() by DMA: the transfer runs on after the call returns, the
+ * completion interrupt marks it done and runs the callback, each core
+ * that shows takes the interrupt, and the strip falls back to the CPU
+ * without a channel.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "Adafruit_NeoPixel.hpp"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "pico/multicore.h"
+#include "pico/stdlib.h"
+#include <vector>
+
+struct DoneLog {
+  Adafruit_NeoPixel *strip;
+  uint32_t           calls;
+  uint64_t           atUs;
+};
+
+static void noteDone(Adafruit_NeoPixel *strip, void *context) {
+  DoneLog *log = (DoneLog *)context;
+  log->strip = strip;
+  log->calls++;
+  log->atUs = time_us_64();
+}
+
+TEST(dma_show_async_returns_while_the_frame_is_sent) {
+  DoneLog log = {NULL, 0, 0};
+  {
+    Adafruit_NeoPixel strip(100, 20, NEO_GRB + NEO_KHZ800);
+    strip.setShowCompleteCallback(noteDone, &log);
+    strip.show(); // claims the channel and waits out the first latch
+    CHECK_EQ(NeoPixelHost::claimedDmaChannels(), 1);
+    CHECK_EQ(log.calls, 1);
+    NeoPixelHost::advance(1000); // past the FIFO draining and the latch
+
+    strip.fill(0x112233);
+    uint64_t t = time_us_64();
+    strip.showAsync();
+    CHECK_EQ(time_us_64(), t);
+    CHECK(!strip.isShowDone());
+    CHECK(!strip.canShow());
+    CHECK_EQ(log.calls, 1);
+    // the pixels were packed, so they may change at once
+    strip.fill(0x445566);
+
+    strip.waitShowDone();
+    CHECK(strip.isShowDone());
+    CHECK_EQ(log.calls, 2);
+    CHECK(log.strip == &strip);
+    // done once the last word is in the FIFO: 8 pixels wait there and
+    // one is being shifted out
+    CHECK_EQ(log.atUs - t, (100 - 9) * 30);
+    CHECK(!strip.canShow()); // still latching
+    NeoPixelHost::settle();
+    strip.setShowCompleteCallback(NULL);
+  }
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(20);
+  CHECK(pin.frames.size() >= 2);
+  if (pin.frames.size() < 2) return;
+  CHECK_EQ(pin.frames[1].bytes.size(), 300);
+  CHECK_EQ(pin.frames[1].bytes[0], 0x22);
+  CHECK_EQ(pin.frames[1].bytes[299], 0x33);
+  CHECK_EQ(pin.frames[1].stallNs, 0);
+}
+
+TEST(dma_show_async_waits_for_the_transfer_before) {
+  Adafruit_NeoPixel strip(50, 21, NEO_GRB + NEO_KHZ800);
+  strip.show();
+  strip.fill(0x010101);
+  strip.showAsync();
+  strip.fill(0x020202);
+  strip.showAsync(); // waits for the first, then for the latch
+  strip.waitShowDone();
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(21);
+  CHECK_EQ(pin.frames.size(), 3);
+  if (pin.frames.size() < 3) return;
+  CHECK_EQ(pin.frames[1].bytes[0], 1);
+  CHECK_EQ(pin.frames[2].bytes[0], 2);
+  CHECK(pin.frames[2].gapNs >= NEOPIXEL_LATCH_US * 1000);
+}
+
+TEST(dma_strip_falls_back_to_the_cpu) {
+  std::vector<int> taken;
+  int ch;
+  while ((ch = dma_claim_unused_channel(false)) != -1) taken.push_back(ch);
+  DoneLog log = {NULL, 0, 0};
+  {
+    Adafruit_NeoPixel strip(20, 22, NEO_GRB + NEO_KHZ800);
+    strip.setShowCompleteCallback(noteDone, &log);
+    strip.fill(0x0A0B0C);
+    strip.showAsync(); // blocks, as the CPU feeds the FIFO
+    CHECK(strip.isShowDone());
+    CHECK_EQ(log.calls, 1);
+    NeoPixelHost::settle();
+    strip.setShowCompleteCallback(NULL);
+  }
+  for (int c : taken) dma_channel_unclaim(c);
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(22);
+  CHECK(pin.frames.size() >= 1);
+  if (pin.frames.empty()) return;
+  CHECK_EQ(pin.frames[0].bytes.size(), 60);
+  CHECK_EQ(pin.frames[0].bytes[0], 0x0B);
+  CHECK_EQ(pin.frames[0].bytes[1], 0x0A);
+}
+
+static Adafruit_NeoPixel *core1_strip;
+
+static void core1_show(void) {
+  core1_strip->show();
+}
+
+TEST(dma_interrupt_is_taken_by_the_core_that_shows) {
+  Adafruit_NeoPixel strip(8, 23, NEO_GRB + NEO_KHZ800);
+  // set up on core 0, which enables DMA_IRQ_0 there
+  CHECK(strip.beginDma());
+  CHECK(NeoPixelHost::irqEnabled(0, DMA_IRQ_0));
+  strip.fill(0x010203);
+  core1_strip = &strip;
+  // show() on core 1 waits for the interrupt there, core 0 being held up
+  multicore_launch_core1(core1_show);
+  multicore_reset_core1();
+  CHECK(NeoPixelHost::irqEnabled(1, DMA_IRQ_0));
+  CHECK(strip.isShowDone());
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(23);
+  CHECK(pin.frames.size() >= 1);
+  if (!pin.frames.empty()) CHECK_EQ(pin.frames[0].bytes[0], 0x02);
+}
@@ -0,0 +1,107 @@
+/*!
+ * @file test_frame.cpp
+ *
+ * FrameView writes: pixels land at their electrical index in wire order,
+ * out of range pixels are skipped, and shift() and blend_from() match a
+ * plain per-pixel reference.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "NeoPixelOrder.hpp"
+#include "pico_neopixel_animations.h"
+#include <vector>
+
+static uint32_t test_color(uint16_t v) {
+  return ((uint32_t)(v + 1) << 16) | ((uint32_t)(v + 101) << 8) | (v + 201);
+}
+
+// Shows the strip at full brightness; the pixels keep their colors
+static const NeoPixelHostPin &show(NeoPixelStrip &np, uint gpio) {
+  NeoPixelHost::clearPins();
+  NeoPixelStrip::brightness = 254;
+  np.propTransitionBrightness(255, 0);
+  NeoPixelHost::settle();
+  return NeoPixelHost::pin(gpio);
+}
+
+TEST(frame_view_writes_wire_order) {
+  uint8_t saved = NeoPixelStrip::brightness;
+  {
+    NeoPixelStrip np(10, 12, neopixel_order_string(10, 3));
+    NeoPixelStrip::FrameView f = np.frame();
+    CHECK_EQ(f.size(), 10);
+    for (uint16_t v = 0 ; v < 10 ; v++) f.set(v, test_color(v));
+    for (uint16_t v = 0 ; v < 10 ; v++) CHECK_EQ(f.get(v), test_color(v));
+
+    const NeoPixelHostPin &pin = show(np, 12);
+    CHECK_EQ(pin.leds.size(), 30);
+    if (pin.leds.size() == 30) {
+      for (uint16_t v = 0 ; v < 10 ; v++) {
+        const uint8_t *p = &pin.leds[np.parseOrder(v) * 3];
+        uint32_t c = test_color(v);
+        CHECK_EQ(p[0], NeoPixelStrip::adjustBrightness(c >> 8));  // G
+        CHECK_EQ(p[1], NeoPixelStrip::adjustBrightness(c >> 16)); // R
+        CHECK_EQ(p[2], NeoPixelStrip::adjustBrightness(c));       // B
+      }
+    }
+  }
+  NeoPixelStrip::brightness = saved;
+}
+
+TEST(frame_view_skips_out_of_range_pixels) {
+  NeoPixelStrip np(10, 13, neopixel_order_string(10, 7));
+  NeoPixelStrip::FrameView f = np.frame();
+  f.fill_range(0, 10, 0x010203);
+  f.set(10, 0xFFFFFF);
+  f.set(1000, 0xFFFFFF);
+  CHECK_EQ(f.get(10), 0);
+  // clipped at the end of the strip
+  f.fill_range(8, 5, 0x0A0B0C);
+  uint32_t colors[4] = {0x111111, 0x222222, 0x333333, 0x444444};
+  f.copy_from(colors, 4, 7);
+  f.copy_from(colors, 4, 10);
+  f.blend_from(colors, 4, 255, 10);
+  for (uint16_t v = 0 ; v < 7 ; v++) CHECK_EQ(f.get(v), 0x010203);
+  CHECK_EQ(f.get(7), 0x111111);
+  CHECK_EQ(f.get(8), 0x222222);
+  CHECK_EQ(f.get(9), 0x333333);
+}
+
+TEST(frame_view_shift_matches_reference) {
+  NeoPixelStrip np(12, 14, neopixel_order_string(12, 5));
+  NeoPixelStrip::FrameView f = np.frame();
+  std::vector<uint32_t> ref(12);
+  for (uint16_t v = 0 ; v < 12 ; v++) {
+    ref[v] = test_color(v);
+    f.set(v, ref[v]);
+  }
+  const int shifts[] = {3, -2, 1, -5, 0, 12, -20};
+  uint32_t fill = 0x00FF00;
+  for (int n : shifts) {
+    std::vector<uint32_t> next(12, fill);
+    for (int v = 0 ; v < 12 ; v++) {
+      if (v - n >= 0 && v - n < 12) next[v] = ref[v - n];
+    }
+    ref = next;
+    f.shift(n, fill);
+    for (uint16_t v = 0 ; v < 12 ; v++) CHECK_EQ(f.get(v), ref[v]);
+    fill += 0x010101;
+  }
+}
+
+TEST(frame_view_blend_from_steps_each_channel) {
+  NeoPixelStrip np(3, 15);
+  NeoPixelStrip::FrameView f = np.frame();
+  f.set(0, 0x000000);
+  f.set(1, 0x102030);
+  f.set(2, 0x405060);
+  const uint32_t to[3] = {0xFF8040, 0x000000, 0x405060};
+  f.blend_from(to, 3, 128);
+  CHECK_EQ(f.get(0), 0x7F4020);
+  CHECK_EQ(f.get(1), 0x081018);
+  CHECK_EQ(f.get(2), 0x405060);
+  // nothing moves at amount 0
+  f.blend_from(to, 3, 0);
+  CHECK_EQ(f.get(0), 0x7F4020);
+}
@@ -0,0 +1,119 @@
+/*!
+ * @file test_group.cpp
+ *
+ * Strip groups: all strips start together, after the one that latches
+ * last, a frame takes as long as the longest strip, and strips the CPU
+ * would have to send are refused.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "NeoPixelStripGroup.hpp"
+#include "hardware/dma.h"
+#include <memory>
+#include <vector>
+
+TEST(group_frame_takes_as_long_as_the_longest_strip) {
+  Adafruit_NeoPixel shortStrip(4, 14, NEO_GRB + NEO_KHZ800);
+  Adafruit_NeoPixel longStrip(60, 15, NEO_GRB + NEO_KHZ800);
+  {
+    NeoPixelStripGroup group;
+    CHECK(group.add(shortStrip));
+    CHECK(group.add(longStrip));
+    shortStrip.fill(0x102030);
+    longStrip.fill(0x405060);
+    // past the latch the strips start with, so the frame time is the wire's
+    NeoPixelHost::advance(NEOPIXEL_LATCH_US);
+    group.show();
+    // done once the long strip's last word is in the FIFO, with 8
+    // pixels waiting there and one being shifted out
+    CHECK_EQ(group.lastFrameTime(), (60 - 9) * 30);
+    CHECK_EQ(group.frameCount(), 1);
+    NeoPixelHost::settle();
+  }
+  const NeoPixelHostPin &s = NeoPixelHost::pin(14);
+  const NeoPixelHostPin &l = NeoPixelHost::pin(15);
+  CHECK(s.frames.size() >= 1);
+  CHECK(l.frames.size() >= 1);
+  if (s.frames.empty() || l.frames.empty()) return;
+  uint64_t a = s.frames[0].startNs, b = l.frames[0].startNs;
+  CHECK((a > b ? a - b : b - a) <= 2000);
+  CHECK_EQ(s.frames[0].bytes.size(), 12);
+  CHECK_EQ(l.frames[0].bytes.size(), 180);
+}
+
+TEST(group_frames_start_together_after_the_last_latch) {
+  Adafruit_NeoPixel shortStrip(4, 14, NEO_GRB + NEO_KHZ800);
+  Adafruit_NeoPixel longStrip(60, 15, NEO_GRB + NEO_KHZ800);
+  {
+    NeoPixelStripGroup group;
+    CHECK(group.add(shortStrip));
+    CHECK(group.add(longStrip));
+    shortStrip.fill(0x102030);
+    longStrip.fill(0x405060);
+    group.show();
+    longStrip.fill(0x0000FF);
+    group.show();
+    NeoPixelHost::settle();
+  }
+  const NeoPixelHostPin &s = NeoPixelHost::pin(14);
+  const NeoPixelHostPin &l = NeoPixelHost::pin(15);
+  // two frames each, plus the blank one from the strips' destructors
+  CHECK(s.frames.size() >= 2);
+  CHECK(l.frames.size() >= 2);
+  uint64_t a = s.frames[1].startNs, b = l.frames[1].startNs;
+  CHECK((a > b ? a - b : b - a) <= 2000);
+  CHECK(l.frames[1].gapNs >= NEOPIXEL_LATCH_US * 1000);
+  // the short strip idles on, rather than starting early
+  CHECK(s.frames[1].gapNs >= l.frames[1].gapNs);
+}
+
+TEST(group_refuses_strips_without_dma) {
+  std::vector<int> taken;
+  int ch;
+  while ((ch = dma_claim_unused_channel(false)) != -1) taken.push_back(ch);
+  {
+    Adafruit_NeoPixel strip(4, 16, NEO_GRB + NEO_KHZ800);
+    NeoPixelStripGroup group;
+    CHECK(!group.add(strip));
+    CHECK_EQ(group.size(), 0);
+  }
+  for (int c : taken) dma_channel_unclaim(c);
+}
+
+TEST(group_takes_a_state_machine_and_a_channel_per_strip) {
+  // as many strips as a group holds, one per state machine
+  const int n = NEOPIXEL_GROUP_MAX_STRIPS;
+  std::unique_ptr<Adafruit_NeoPixel> strips[n];
+  {
+    NeoPixelStripGroup group;
+    for (int i = 0 ; i < n ; i++) {
+      strips[i].reset(new Adafruit_NeoPixel(4, 2 + i, NEO_GRB + NEO_KHZ800));
+      CHECK(group.add(*strips[i]));
+    }
+    CHECK_EQ(group.size(), n);
+    CHECK_EQ(NeoPixelHost::freeStateMachines(pio0), 0);
+    CHECK_EQ(NeoPixelHost::freeStateMachines(pio1), 0);
+    CHECK_EQ(NeoPixelHost::claimedDmaChannels(), n);
+    // both pios load the program once
+    CHECK_EQ(NeoPixelHost::freeInstructions(pio0), PIO_INSTRUCTION_COUNT - ws2812byte_program.length);
+    CHECK_EQ(NeoPixelHost::freeInstructions(pio1), PIO_INSTRUCTION_COUNT - ws2812byte_program.length);
+
+    // the group is full, and so are the state machines
+    Adafruit_NeoPixel extra(4, 20, NEO_GRB + NEO_KHZ800);
+    CHECK(!group.add(extra));
+    CHECK(!extra.beginDma());
+    CHECK(extra.getPioStatus() == NeoPixelPioStatus::NoStateMachine);
+    CHECK_EQ(group.size(), n);
+
+    for (int i = 0 ; i < n ; i++) strips[i]->fill(0x010203 * (i + 1));
+    group.show();
+    NeoPixelHost::settle();
+  }
+  for (int i = 0 ; i < n ; i++) {
+    const NeoPixelHostPin &pin = NeoPixelHost::pin(2 + i);
+    CHECK(pin.frames.size() >= 1);
+    if (pin.frames.size() >= 1) CHECK_EQ(pin.frames[0].bytes[0], 2 * (i + 1));
+  }
+  for (std::unique_ptr<Adafruit_NeoPixel> &strip : strips) strip.reset();
+}
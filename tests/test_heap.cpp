@@ -0,0 +1,74 @@
+/*!
+ * @file test_heap.cpp
+ *
+ * Strips on static storage make no heap allocations, from construction
+ * through showing frames to destruction.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "Adafruit_NeoPixel.hpp"
+#include "pico_neopixel_animations.h"
+
+TEST(heap_strip_allocates) {
+  uint32_t before = NeoPixelHost::allocations();
+  {
+    Adafruit_NeoPixel strip(8, 21, NEO_GRB + NEO_KHZ800);
+    strip.begin();
+    strip.show();
+  }
+  CHECK(NeoPixelHost::allocations() > before);
+}
+
+TEST(static_strip_makes_no_allocations) {
+  static NeoPixelStaticBuffers<60> buffers;
+  uint32_t before = NeoPixelHost::allocations();
+  {
+    Adafruit_NeoPixel strip(21, NEO_GRB + NEO_KHZ800, buffers);
+    strip.begin();
+    strip.fill(0x102030);
+    strip.show();
+    strip.setPixelColor(5, 0x405060);
+    strip.showChanged();
+    strip.setBrightness(40);
+    strip.show();
+    NeoPixelHost::settle();
+  }
+  CHECK_EQ(NeoPixelHost::allocations() - before, 0);
+}
+
+TEST(static_animation_strip_makes_no_allocations) {
+  static NeoPixelStripStorage<60> storage;
+  uint32_t before = NeoPixelHost::allocations();
+  {
+    NeoPixelStrip np(22, storage);
+    NeoPixelStrip::FrameView f = np.frame();
+    f.fill_range(0, 60, 0x0A0B0C);
+    f.shift(3, 0x010203);
+    np.transitionBrightness(200, 40);
+    np.htmlSinglePixel(7, 0x112233, 0);
+    np.htmlRetargetPixel(9, 0x445566, 30);
+    while (np.pollTransitions()) sleep_ms(1);
+    np.colorWipe(0x223344, 0);
+    // twice, as the start colors are sized on first use
+    np.transitionAll(0x304050, 60);
+    np.transitionAll(0x050607, 60);
+    NeoPixelHost::settle();
+  }
+  CHECK_EQ(NeoPixelHost::allocations() - before, 0);
+}
+
+TEST(static_strip_order_string_fits_its_storage) {
+  static NeoPixelStripStorage<8> storage;
+  uint32_t before = NeoPixelHost::allocations();
+  {
+    // explicit entries, then the rest of the strip in order
+    NeoPixelStrip np(23, storage, "2 0 1 d");
+    CHECK_EQ(np.parseOrder(0), 1);
+    CHECK_EQ(np.parseOrder(1), 2);
+    CHECK_EQ(np.parseOrder(2), 0);
+    for (uint16_t v = 3 ; v < 8 ; v++) CHECK_EQ(np.parseOrder(v), v);
+    NeoPixelHost::settle();
+  }
+  CHECK_EQ(NeoPixelHost::allocations() - before, 0);
+}
@@ -0,0 +1,77 @@
+/*!
+ * @file test_host.cpp
+ *
+ * The stub SDK itself: the fake clock, and a strip's frame arriving on
+ * its virtual LEDs bit for bit and at the right speed.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "Adafruit_NeoPixel.hpp"
+#include "pico_neopixel_animations.h"
+#include "pico/stdlib.h"
+#include <vector>
+
+TEST(clock_moves_only_when_waiting) {
+  uint64_t t = time_us_64();
+  CHECK_EQ(time_us_64(), t);
+  sleep_ms(3);
+  CHECK_EQ(time_us_64(), t + 3000);
+  sleep_until(from_us_since_boot(t + 5000));
+  CHECK_EQ(time_us_64(), t + 5000);
+  NeoPixelHost::advance(7);
+  CHECK_EQ(time_us_64(), t + 5007);
+}
+
+TEST(strip_frame_reaches_leds) {
+  Adafruit_NeoPixel strip(4, 2, NEO_GRB + NEO_KHZ800);
+  strip.setPixelColor(0, 0xFF0000);
+  strip.setPixelColor(1, 0x00FF00);
+  strip.setPixelColor(2, 0x0000FF);
+  strip.setPixelColor(3, 0x123456);
+  strip.show();
+  NeoPixelHost::settle();
+
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(2);
+  CHECK_EQ(pin.frames.size(), 1);
+  std::vector<uint8_t> sent(strip.getPixels(), strip.getPixels() + strip.getNumBytes());
+  CHECK(pin.leds == sent);
+  CHECK_EQ(pin.leds[0], 0x00); // green first
+  CHECK_EQ(pin.leds[1], 0xFF);
+  // 96 bits at 1.25 us
+  CHECK_EQ(pin.frames[0].endNs - pin.frames[0].startNs, 96 * 1250);
+}
+
+TEST(strip_at_400khz_takes_twice_as_long) {
+  Adafruit_NeoPixel strip(4, 3, NEO_RGB + NEO_KHZ400);
+  strip.fill(0x010203);
+  strip.show();
+  NeoPixelHost::settle();
+
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(3);
+  CHECK_EQ(pin.frames.size(), 1);
+  CHECK_EQ(pin.frames[0].endNs - pin.frames[0].startNs, 96 * 2500);
+  CHECK_EQ(pin.leds[0], 1);
+  CHECK_EQ(pin.leds[11], 3);
+}
+
+TEST(animation_runs_on_fake_clock) {
+  uint8_t saved = NeoPixelStrip::brightness;
+  NeoPixelStrip::brightness = 255; // starts at 0, for initialFadeIn()
+  NeoPixelStrip npStrip(8, 6);
+  NeoPixelHost::clearPins();
+  uint64_t t = time_us_64();
+  npStrip.colorWipe(npStrip.packColor(0, 0, 255), 10);
+  CHECK(time_us_64() - t >= 8 * 10000);
+  NeoPixelHost::settle();
+
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(6);
+  CHECK_EQ(pin.leds.size(), 8 * 3);
+  CHECK(pin.leds[2] != 0);
+  for (int i = 0 ; i < 8 ; i++) {
+    CHECK_EQ(pin.leds[i * 3], 0);
+    CHECK_EQ(pin.leds[i * 3 + 1], 0);
+    CHECK_EQ(pin.leds[i * 3 + 2], pin.leds[2]);
+  }
+  NeoPixelStrip::brightness = saved;
+}
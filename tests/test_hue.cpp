@@ -0,0 +1,19 @@
+/*!
+ * @file test_hue.cpp
+ *
+ * The compile-time hue table against gamma32(ColorHSV()) for every hue.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_hue.h"
+
+TEST(hue_color_matches_color_hsv_for_every_hue) {
+  uint32_t mismatches = 0;
+  for (uint32_t h = 0 ; h < 65536 ; h++) {
+    uint32_t want = Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(h));
+    if (neopixelHueColor(h) != want) mismatches++;
+  }
+  CHECK_EQ(mismatches, 0);
+}
+
@@ -0,0 +1,96 @@
+/*!
+ * @file test_latch.cpp
+ *
+ * The reset time between frames of one strip: back to back frames are
+ * never closer than NEOPIXEL_LATCH_US, and time the caller spends
+ * rendering counts towards it, so show() waits no longer than needed.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "Adafruit_NeoPixel.hpp"
+#include "hardware/dma.h"
+#include "pico/stdlib.h"
+#include <vector>
+
+// markEndTime() counts the word being shifted out whole, which on the
+// host is exact; allow a little for the calls in between
+static const uint64_t overwaitNs = 2000;
+
+// Shows frames with render_us of rendering between them and checks the
+// gaps on the wire
+static void checkGaps(uint gpio, uint64_t render_us) {
+  {
+    Adafruit_NeoPixel strip(50, gpio, NEO_GRB + NEO_KHZ800);
+    strip.show();
+    for (int i = 0 ; i < 5 ; i++) {
+      NeoPixelHost::advance(render_us);
+      strip.fill(0x010101 * (i + 1));
+      strip.show();
+    }
+    NeoPixelHost::settle();
+  }
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(gpio);
+  CHECK(pin.frames.size() >= 6);
+  for (size_t i = 1 ; i < 6 && i < pin.frames.size() ; i++) {
+    uint64_t gap = pin.frames[i].gapNs;
+    CHECK(gap >= NEOPIXEL_LATCH_US * 1000);
+    if (render_us * 1000 < NEOPIXEL_LATCH_US * 1000) {
+      // show() waited for the rest of the latch only
+      CHECK(gap <= NEOPIXEL_LATCH_US * 1000 + overwaitNs);
+    }
+  }
+}
+
+TEST(latch_back_to_back_frames_keep_the_reset_time) {
+  checkGaps(21, 0);
+  checkGaps(21, 120);
+}
+
+TEST(latch_back_to_back_frames_keep_the_reset_time_without_dma) {
+  std::vector<int> taken;
+  int ch;
+  while ((ch = dma_claim_unused_channel(false)) != -1) taken.push_back(ch);
+  checkGaps(22, 0);
+  checkGaps(22, 120);
+  for (int c : taken) dma_channel_unclaim(c);
+}
+
+TEST(latch_rendering_past_the_latch_does_not_wait) {
+  Adafruit_NeoPixel strip(50, 23, NEO_GRB + NEO_KHZ800);
+  strip.show();
+  strip.waitShowDone();
+  CHECK(!strip.canShow());
+  // rendering the next frame takes longer than the 9 words left in the
+  // FIFO and the latch after them
+  NeoPixelHost::advance(9 * 30 + NEOPIXEL_LATCH_US + 200);
+  CHECK(strip.canShow());
+  strip.fill(0x203040);
+  uint64_t t = NeoPixelHost::now();
+  strip.show();
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(23);
+  CHECK_EQ(pin.frames.size(), 2);
+  if (pin.frames.size() == 2) {
+    // the frame starts as soon as it is packed
+    CHECK(pin.frames[1].startNs >= t);
+    CHECK(pin.frames[1].startNs - t <= 2000);
+  }
+}
+
+TEST(latch_can_show_matches_the_wire) {
+  Adafruit_NeoPixel strip(50, 24, NEO_GRB + NEO_KHZ800);
+  strip.show();
+  strip.waitShowDone();
+  // canShow() turns true once the last bit has been idle for the latch
+  while (!strip.canShow()) NeoPixelHost::advance(1);
+  uint64_t t = NeoPixelHost::now();
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(24);
+  CHECK(pin.frames.size() >= 1);
+  if (pin.frames.size() >= 1) {
+    uint64_t idle = t - pin.frames[0].endNs;
+    CHECK(idle >= NEOPIXEL_LATCH_US * 1000);
+    CHECK(idle <= NEOPIXEL_LATCH_US * 1000 + overwaitNs);
+  }
+}
@@ -0,0 +1,35 @@
+/*!
+ * @file test_order.cpp
+ *
+ * parseOrder() against the linear scan of pixelOrder it replaced.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "NeoPixelOrder.hpp"
+#include "pico_neopixel_animations.h"
+
+TEST(parse_order_matches_linear_scan) {
+  NeoPixelStrip np(50, 27, neopixel_order_string(50, 17));
+  std::vector<int> order = neopixel_order_vector(50, 17);
+  for (uint16_t v = 0 ; v < 50 ; v++) {
+    CHECK_EQ(np.parseOrder(v), neopixel_order_scan(order, v));
+  }
+  // beyond the strip, positions map onto themselves
+  CHECK_EQ(np.parseOrder(50), 50);
+  CHECK_EQ(np.parseOrder(1000), 1000);
+}
+
+TEST(parse_order_default_is_identity) {
+  NeoPixelStrip np(20, 28);
+  for (uint16_t v = 0 ; v < 20 ; v++) CHECK_EQ(np.parseOrder(v), v);
+}
+
+TEST(parse_order_short_string_keeps_the_rest) {
+  // the order string covers the first three pixels only
+  NeoPixelStrip np(6, 29, "2 0 1 ");
+  CHECK_EQ(np.parseOrder(2), 0);
+  CHECK_EQ(np.parseOrder(0), 1);
+  CHECK_EQ(np.parseOrder(1), 2);
+  for (uint16_t v = 3 ; v < 6 ; v++) CHECK_EQ(np.parseOrder(v), v);
+}
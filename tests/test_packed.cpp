@@ -0,0 +1,73 @@
+/*!
+ * @file test_packed.cpp
+ *
+ * One packed pixel per FIFO word: the bits on the wire are exactly the
+ * pixel bytes, MSB first, at the bit rate, with no stalls.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "Adafruit_NeoPixel.hpp"
+#include <vector>
+
+// Bytes that tell the bit order and every byte position apart
+static uint8_t patternByte(uint16_t i) {
+  static const uint8_t patterns[] = {0x80, 0x01, 0xAA, 0x55, 0xF0, 0x0F, 0xFF, 0x00, 0x81, 0x7E};
+  return patterns[i % sizeof(patterns)] ^ (uint8_t)(i / sizeof(patterns));
+}
+
+static void checkWaveform(neoPixelType type, uint16_t n, uint8_t gpio, uint32_t bitNs) {
+  std::vector<uint8_t> sent;
+  uint32_t words;
+  {
+    Adafruit_NeoPixel strip(n, gpio, type);
+    uint8_t *p = strip.getPixels();
+    for (uint16_t i = 0 ; i < strip.getNumBytes() ; i++) p[i] = patternByte(i);
+    strip.markDirty();
+    sent.assign(p, p + strip.getNumBytes());
+    uint32_t before = NeoPixelHost::fifoWrites();
+    strip.show();
+    words = NeoPixelHost::fifoWrites() - before;
+    NeoPixelHost::settle();
+  }
+  CHECK_EQ(words, n);
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(gpio);
+  CHECK(pin.frames.size() >= 1);
+  if (pin.frames.empty()) return;
+  const NeoPixelHostFrame &f = pin.frames[0];
+  CHECK(f.bytes == sent);
+  CHECK_EQ(f.endNs - f.startNs, (uint64_t)sent.size() * 8 * bitNs);
+  CHECK_EQ(f.stallNs, 0);
+}
+
+TEST(packed_rgb_waveform_is_bit_exact) {
+  checkWaveform(NEO_GRB + NEO_KHZ800, 37, 23, 1250);
+}
+
+TEST(packed_rgbw_waveform_is_bit_exact) {
+  checkWaveform(NEO_GRBW + NEO_KHZ800, 37, 24, 1250);
+}
+
+TEST(packed_rgbw_400khz_waveform_is_bit_exact) {
+  checkWaveform(NEO_RGBW + NEO_KHZ400, 9, 25, 2500);
+}
+
+TEST(packed_words_follow_a_type_change) {
+  Adafruit_NeoPixel strip(4, 26, NEO_GRB + NEO_KHZ800);
+  strip.fill(0x010203);
+  strip.show();
+  NeoPixelHost::advance(1000);
+  // RGB to RGBW after the state machine is set up: 32 bits per word now
+  strip.updateType(NEO_GRBW + NEO_KHZ800);
+  strip.fill(0x04050607);
+  strip.show();
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(26);
+  CHECK(pin.frames.size() >= 2);
+  if (pin.frames.size() < 2) return;
+  std::vector<uint8_t> rgb = {2, 1, 3}, rgbw = {6, 5, 7, 4};
+  CHECK_EQ(pin.frames[0].bytes.size(), 12);
+  CHECK_EQ(pin.frames[1].bytes.size(), 16);
+  CHECK(std::vector<uint8_t>(pin.frames[0].bytes.begin(), pin.frames[0].bytes.begin() + 3) == rgb);
+  CHECK(std::vector<uint8_t>(pin.frames[1].bytes.end() - 4, pin.frames[1].bytes.end()) == rgbw);
+}
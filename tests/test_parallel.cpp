@@ -0,0 +1,93 @@
+/*!
+ * @file test_parallel.cpp
+ *
+ * Parallel output: the bit-plane transpose, lanes arriving on their pins
+ * and the latch between frames.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "NeoPixelParallel.hpp"
+#include "NeoPixelTranspose.hpp"
+#include "hardware/dma.h"
+#include <vector>
+
+TEST(parallel_transpose8_matches_reference) {
+  uint8_t a[8];
+  uint32_t fast[2], ref[2];
+  // every value in every lane, against varying neighbours
+  for (int n = 0 ; n < 8 ; n++) {
+    for (int v = 0 ; v < 256 ; v++) {
+      for (int k = 0 ; k < 8 ; k++) a[k] = (uint8_t)(k * 37 + v * 11);
+      a[n] = (uint8_t)v;
+      NeoPixelParallel::transpose8(a, fast);
+      neopixel_transpose8_reference(a, ref);
+      CHECK_EQ(fast[0], ref[0]);
+      CHECK_EQ(fast[1], ref[1]);
+    }
+  }
+  uint32_t x = 12345;
+  for (int i = 0 ; i < 10000 ; i++) {
+    for (int k = 0 ; k < 8 ; k++) { x = x * 1103515245 + 12345; a[k] = x >> 16; }
+    NeoPixelParallel::transpose8(a, fast);
+    neopixel_transpose8_reference(a, ref);
+    CHECK_EQ(fast[0], ref[0]);
+    CHECK_EQ(fast[1], ref[1]);
+  }
+}
+
+TEST(parallel_lanes_reach_their_pins) {
+  Adafruit_NeoPixel lane0(3, 0, NEO_GRB + NEO_KHZ800), lane1(2, 0, NEO_RGBW + NEO_KHZ800);
+  lane0.setPixelColor(0, 0x123456);
+  lane0.setPixelColor(2, 0xFF00FF);
+  lane1.setPixelColor(1, 0x01020304);
+  {
+    NeoPixelParallel out(10, 2);
+    out.setLane(0, &lane0);
+    out.setLane(1, &lane1);
+    out.show();
+    NeoPixelHost::settle();
+  }
+  std::vector<uint8_t> sent0(lane0.getPixels(), lane0.getPixels() + lane0.getNumBytes());
+  std::vector<uint8_t> sent1(lane1.getPixels(), lane1.getPixels() + lane1.getNumBytes());
+  // the shorter lane is padded with zero bits
+  sent1.resize(sent0.size());
+  CHECK(NeoPixelHost::pin(10).leds == sent0);
+  CHECK(NeoPixelHost::pin(11).leds == sent1);
+  // 9 bytes at 1.25 us per bit, for both lanes at once
+  CHECK_EQ(NeoPixelHost::pin(10).frames[0].endNs - NeoPixelHost::pin(10).frames[0].startNs, 72 * 1250);
+}
+
+// Back to back frames: each one has to wait until the previous one has
+// been off the pins for the latch time, but not any longer.
+static void check_latch(uint8_t basePin) {
+  Adafruit_NeoPixel lane(20, 0, NEO_GRB + NEO_KHZ800);
+  lane.fill(0x808080);
+  {
+    NeoPixelParallel out(basePin, 1);
+    out.setLane(0, &lane);
+    for (int i = 0 ; i < 4 ; i++) out.showAsync();
+    CHECK(!out.canShow());
+    out.waitShowDone();
+    NeoPixelHost::settle();
+  }
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(basePin);
+  CHECK_EQ(pin.frames.size(), 4);
+  for (size_t i = 1 ; i < pin.frames.size() ; i++) {
+    CHECK(pin.frames[i].gapNs >= NEOPIXEL_LATCH_US * 1000);
+    // the end estimate rounds a FIFO word up, plus a tick of the wait loop
+    CHECK(pin.frames[i].gapNs <= (NEOPIXEL_LATCH_US + 8) * 1000);
+  }
+}
+
+TEST(parallel_frames_wait_for_the_latch) {
+  check_latch(12);
+}
+
+TEST(parallel_frames_wait_for_the_latch_without_dma) {
+  std::vector<int> taken;
+  int ch;
+  while ((ch = dma_claim_unused_channel(false)) != -1) taken.push_back(ch);
+  check_latch(13);
+  for (int c : taken) dma_channel_unclaim(c);
+}
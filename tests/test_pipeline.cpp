@@ -0,0 +1,92 @@
+/*!
+ * @file test_pipeline.cpp
+ *
+ * The frame queue between two threads, and the core 1 pipeline sending
+ * snapshots while core 0 keeps changing pixels.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "NeoPixelPipeline.hpp"
+#include "hardware/irq.h"
+#include <thread>
+
+TEST(frame_queue_passes_items_in_order_between_threads) {
+  static NeoPixelFrameQueue<uint32_t, 4> queue;
+  const uint32_t count = 100000;
+  uint32_t received = 0;
+  bool ordered = true;
+  std::thread consumer([&]() {
+    uint32_t v;
+    while (received < count) {
+      if (!queue.pop(v)) { std::this_thread::yield(); continue; }
+      if (v != received) ordered = false;
+      received++;
+    }
+  });
+  for (uint32_t i = 0 ; i < count ; ) {
+    if (queue.push(i)) i++;
+    else std::this_thread::yield();
+  }
+  consumer.join();
+  CHECK_EQ(received, count);
+  CHECK(ordered);
+  CHECK(queue.empty());
+}
+
+TEST(frame_queue_holds_one_less_than_its_size) {
+  NeoPixelFrameQueue<int, 3> queue;
+  int v;
+  CHECK(!queue.pop(v));
+  CHECK(queue.push(1));
+  CHECK(queue.push(2));
+  CHECK(!queue.push(3));
+  CHECK(queue.pop(v));
+  CHECK_EQ(v, 1);
+  CHECK(queue.push(3));
+  CHECK(queue.pop(v));
+  CHECK_EQ(v, 2);
+  CHECK(queue.pop(v));
+  CHECK_EQ(v, 3);
+  CHECK(queue.empty());
+}
+
+TEST(pipeline_sends_every_submitted_frame) {
+  Adafruit_NeoPixel strip(8, 17, NEO_GRB + NEO_KHZ800);
+  {
+    NeoPixelPipeline pipeline(strip);
+    CHECK(pipeline.begin());
+    // core 0 waits for the transfers in flush(), so it takes their interrupts
+    CHECK(NeoPixelHost::irqEnabled(0, DMA_IRQ_0));
+    for (int i = 1 ; i <= 5 ; i++) {
+      strip.fill(strip.Color(i, 2 * i, 3 * i));
+      pipeline.submit();
+    }
+    pipeline.end();
+  }
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(17);
+  CHECK_EQ(pin.frames.size(), 5);
+  for (size_t i = 0 ; i < pin.frames.size() ; i++) {
+    CHECK_EQ(pin.frames[i].bytes.size(), 8 * 3);
+    CHECK_EQ(pin.frames[i].bytes[0], 2 * (i + 1)); // green first
+  }
+}
+
+TEST(pipeline_leaves_changed_pixels_to_show_changed) {
+  Adafruit_NeoPixel strip(8, 18, NEO_GRB + NEO_KHZ800);
+  {
+    NeoPixelPipeline pipeline(strip);
+    CHECK(pipeline.begin());
+    strip.show(); // nothing dirty from here on
+    strip.setPixelColor(2, 0x00FF00);
+    // core 1 sends the snapshot; the pixel buffer stays dirty
+    pipeline.submit();
+    pipeline.end();
+  }
+  strip.showChanged();
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(18);
+  CHECK_EQ(pin.frames.size(), 3);
+  if (pin.frames.size() == 3) CHECK_EQ(pin.frames[2].bytes.size(), 3 * 3);
+}
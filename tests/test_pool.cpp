@@ -0,0 +1,93 @@
+/*!
+ * @file test_pool.cpp
+ *
+ * Single pixel fades through htmlRetargetPixel() on the fake clock: each
+ * pixel runs on its own clock, a retarget carries on from the current
+ * color, and a full pool makes room by finishing its oldest fade.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_animations.h"
+
+// Moves the clock on by ms and lets the pool take its frame
+static void frameAfter(NeoPixelStrip &np, uint32_t ms) {
+  NeoPixelHost::advance(ms * 1000);
+  np.pollTransitions();
+}
+
+static uint8_t red(uint32_t c) { return c >> 16; }
+
+TEST(pool_second_pixel_starts_while_the_first_fades) {
+  NeoPixelStrip np(8, 24);
+  NeoPixelStrip::FrameView f = np.frame();
+  f.fill_range(0, 8, 0);
+  CHECK(np.htmlRetargetPixel(1, 0xC80000, 200));
+  frameAfter(np, 0);
+  frameAfter(np, 100);
+  uint8_t first = red(f.get(1));
+  CHECK(first > 0 && first < 0xC8);
+
+  CHECK(np.htmlRetargetPixel(4, 0x0000C8, 200));
+  frameAfter(np, 20);
+  // the new pixel moves on the next frame, the first keeps its course
+  CHECK(f.get(4) != 0);
+  CHECK((f.get(4) & 0xFFFF00) == 0);
+  CHECK(red(f.get(1)) > first);
+  CHECK(red(f.get(1)) < 0xC8);
+
+  while (np.pollTransitions()) sleep_ms(1);
+  CHECK_EQ(f.get(1), 0xC80000);
+  CHECK_EQ(f.get(4), 0x0000C8);
+  NeoPixelHost::settle();
+}
+
+TEST(pool_retarget_continues_from_the_current_color) {
+  NeoPixelStrip np(8, 25);
+  NeoPixelStrip::FrameView f = np.frame();
+  f.fill_range(0, 8, 0);
+  CHECK(np.htmlRetargetPixel(2, 0xC8C8C8, 200));
+  frameAfter(np, 0);
+  frameAfter(np, 100);
+  uint32_t mid = f.get(2);
+  CHECK(red(mid) > 0 && red(mid) < 0xC8);
+
+  // back to black, from where it is rather than from either end
+  CHECK(np.htmlRetargetPixel(2, 0x000000, 200));
+  frameAfter(np, 0);
+  CHECK_EQ(f.get(2), mid);
+  frameAfter(np, 100);
+  CHECK(red(f.get(2)) > 0);
+  CHECK(red(f.get(2)) < red(mid));
+
+  while (np.pollTransitions()) sleep_ms(1);
+  CHECK_EQ(f.get(2), 0);
+  NeoPixelHost::settle();
+}
+
+TEST(pool_full_finishes_the_oldest_fade) {
+  const uint16_t n = NEOPIXEL_TRANSITION_SLOTS + 1;
+  NeoPixelStrip np(n, 26);
+  NeoPixelStrip::FrameView f = np.frame();
+  f.fill_range(0, n, 0);
+  // one pixel per slot, each started a millisecond after the last
+  for (uint16_t v = 0 ; v < NEOPIXEL_TRANSITION_SLOTS ; v++) {
+    CHECK(np.htmlRetargetPixel(v, 0x0A0B0C, 1000));
+    NeoPixelHost::advance(1000);
+  }
+  frameAfter(np, 0);
+  for (uint16_t v = 0 ; v < NEOPIXEL_TRANSITION_SLOTS ; v++) CHECK(f.get(v) != 0x0A0B0C);
+
+  // one more pixel: the first fade jumps to its end to free its slot
+  CHECK(np.htmlRetargetPixel(NEOPIXEL_TRANSITION_SLOTS, 0x0A0B0C, 1000));
+  CHECK_EQ(f.get(0), 0x0A0B0C);
+  for (uint16_t v = 1 ; v < NEOPIXEL_TRANSITION_SLOTS ; v++) CHECK(f.get(v) != 0x0A0B0C);
+
+  // and stays there while the others go on
+  frameAfter(np, 500);
+  CHECK_EQ(f.get(0), 0x0A0B0C);
+  CHECK(f.get(NEOPIXEL_TRANSITION_SLOTS) != 0);
+  while (np.pollTransitions()) sleep_ms(1);
+  for (uint16_t v = 0 ; v < n ; v++) CHECK_EQ(f.get(v), 0x0A0B0C);
+  NeoPixelHost::settle();
+}
@@ -0,0 +1,77 @@
+/*!
+ * @file test_propstep.cpp
+ *
+ * propStepPacked(), propStepColor() and propStepColors() against
+ * propStep() one byte at a time, for every start and finish byte.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_animations.h"
+
+static const uint8_t steps[][2] = {
+  {2, 10}, {1, 1}, {0, 0}, {0, 10}, {5, 3}, {1, 255}, {255, 255}, {128, 64}
+};
+
+TEST(prop_step_packed_matches_scalar_in_every_lane) {
+  NeoPixelStrip np(1, 16);
+  for (const uint8_t *s : steps) {
+    uint32_t mismatches = 0;
+    for (int a = 0 ; a < 256 ; a++) {
+      for (int b = 0 ; b < 256 ; b++) {
+        uint32_t expect = np.propStep(a, b, s[0], s[1]);
+        // the same pair in each lane, with other pairs next to it
+        uint32_t other_a = (a * 7 + 13) & 0xFF, other_b = 255 - b;
+        uint32_t other = np.propStep(other_a, other_b, s[0], s[1]);
+        for (int lane = 0 ; lane < 4 ; lane++) {
+          uint32_t start = 0, finish = 0, want = 0;
+          for (int l = 0 ; l < 4 ; l++) {
+            bool here = (l == lane);
+            start  |= (here ? a : other_a) << (8 * l);
+            finish |= (here ? b : other_b) << (8 * l);
+            want   |= (here ? expect : other) << (8 * l);
+          }
+          if (NeoPixelStrip::propStepPacked(start, finish, s[0], s[1]) != want) {
+            mismatches++;
+          }
+        }
+      }
+    }
+    CHECK_EQ(mismatches, 0);
+  }
+}
+
+// propStepColor() one byte at a time
+static uint32_t scalar_step_color(NeoPixelStrip &np, uint32_t start, uint32_t finish) {
+  uint32_t color = 0;
+  for (int shift = 0 ; shift < 24 ; shift += 8) {
+    color |= (uint32_t)np.propStep(start >> shift, finish >> shift, 2, 10) << shift;
+  }
+  return color;
+}
+
+TEST(prop_step_colors_matches_scalar_prop_step) {
+  NeoPixelStrip np(1, 17);
+  const uint16_t n = 256;
+  uint32_t current[n], finish[n], expect[n];
+  for (uint16_t i = 0 ; i < n ; i++) {
+    // white bytes are dropped, as propStepColor() has none
+    current[i] = 0xAB000000 | (i << 16) | ((255 - i) << 8) | (i * 37 & 0xFF);
+    finish[i]  = 0x12000000 | ((i * 11 & 0xFF) << 16) | (i << 8) | (255 - i);
+  }
+  // 2 per step at least, so every byte arrives within 128 rounds
+  for (int round = 0 ; round < 128 ; round++) {
+    for (uint16_t i = 0 ; i < n ; i++) {
+      expect[i] = scalar_step_color(np, current[i], finish[i]);
+      if (i % 16 == 0) CHECK_EQ(np.propStepColor(current[i], finish[i], 2, 10), expect[i]);
+    }
+    NeoPixelStrip::propStepColors(current, finish, n, 2, 10);
+    uint32_t mismatches = 0;
+    for (uint16_t i = 0 ; i < n ; i++) {
+      if (current[i] != expect[i]) mismatches++;
+    }
+    CHECK_EQ(mismatches, 0);
+  }
+  // they all get there
+  for (uint16_t i = 0 ; i < n ; i++) CHECK_EQ(current[i], finish[i] & 0x00FFFFFF);
+}
@@ -0,0 +1,223 @@
+/*!
+ * @file test_registry.cpp
+ *
+ * NeoPixelPioRegistry on the host's PIO model: claiming and releasing
+ * state machines and programs, and why a claim fails.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "NeoPixelPioRegistry.hpp"
+#include "NeoPixelLock.hpp"
+#include "pico/sync.h"
+#include "Adafruit_NeoPixel.hpp"
+#include "ws2812byte.pio.h"
+#include <cstring>
+#include <memory>
+#include <thread>
+
+static const uint16_t nops[PIO_INSTRUCTION_COUNT] = {0};
+// fills a pio but for 2 instructions, too few for ws2812byte
+static const pio_program_t filler = {nops, PIO_INSTRUCTION_COUNT - 2, -1};
+// small programs that take the registry's slots
+static const pio_program_t other1 = {nops, 2, -1};
+static const pio_program_t other2 = {nops, 3, -1};
+static const pio_program_t other3 = {nops, 2, -1};
+static const pio_program_t other4 = {nops, 3, -1};
+
+// claimed and released while the test runner is being constructed,
+// before main(), like a global strip shown from a constructor
+static NeoPixelPioStatus claimAndRelease(void) {
+  NeoPixelPioClaim claim;
+  NeoPixelPioStatus status = NeoPixelPioRegistry::claim(&ws2812byte_program, claim);
+  NeoPixelPioRegistry::release(&ws2812byte_program, claim);
+  return status;
+}
+
+static NeoPixelPioStatus staticStatus = claimAndRelease();
+
+TEST(registry_claims_during_static_construction) {
+  CHECK(staticStatus == NeoPixelPioStatus::Ok);
+}
+
+TEST(registry_claims_from_both_cores) {
+  // two threads claim and release as fast as they can; the lock has to
+  // keep the use counts and the program slots consistent
+  auto churn = []() {
+    for (int i = 0 ; i < 20000 ; i++) {
+      NeoPixelPioClaim claim;
+      if (NeoPixelPioRegistry::claim(&ws2812byte_program, claim) == NeoPixelPioStatus::Ok)
+        NeoPixelPioRegistry::release(&ws2812byte_program, claim);
+    }
+  };
+  std::thread other(churn);
+  churn();
+  other.join();
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), 0);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio1, &ws2812byte_program), 0);
+}
+
+TEST(registry_lock_is_not_a_critical_section_lock) {
+  // critical sections share the striped locks; with all of them held the
+  // registry must still be able to take its own
+  critical_section_t sections[PICO_SPINLOCK_ID_STRIPED_LAST - PICO_SPINLOCK_ID_STRIPED_FIRST + 1];
+  for (critical_section_t &s : sections) critical_section_init(&s);
+  for (critical_section_t &s : sections) {
+    critical_section_enter_blocking(&s);
+    NeoPixelPioClaim claim;
+    CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, claim) == NeoPixelPioStatus::Ok);
+    NeoPixelPioRegistry::release(&ws2812byte_program, claim);
+    critical_section_exit(&s);
+  }
+  for (critical_section_t &s : sections) critical_section_deinit(&s);
+  // and it is claimed, so no one else is handed it
+  CHECK(spin_lock_is_claimed(NEOPIXEL_SPINLOCK_ID));
+  int others[PICO_SPINLOCK_ID_CLAIM_FREE_LAST - PICO_SPINLOCK_ID_CLAIM_FREE_FIRST + 1];
+  int n = 0, id;
+  while ((id = spin_lock_claim_unused(false)) != -1) {
+    CHECK(id != NEOPIXEL_SPINLOCK_ID);
+    others[n++] = id;
+  }
+  for (int i = 0 ; i < n ; i++) spin_lock_unclaim(others[i]);
+}
+
+TEST(registry_fills_both_pios) {
+  NeoPixelPioClaim claims[2 * NUM_PIO_STATE_MACHINES + 1];
+  for (int i = 0 ; i < 2 * NUM_PIO_STATE_MACHINES ; i++) {
+    CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, claims[i]) == NeoPixelPioStatus::Ok);
+    // pio0 first
+    CHECK(claims[i].pio == (i < NUM_PIO_STATE_MACHINES ? pio0 : pio1));
+  }
+  CHECK_EQ(NeoPixelHost::freeStateMachines(pio0), 0);
+  CHECK_EQ(NeoPixelHost::freeStateMachines(pio1), 0);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), NUM_PIO_STATE_MACHINES);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio1, &ws2812byte_program), NUM_PIO_STATE_MACHINES);
+  // the program is loaded once per pio
+  CHECK_EQ(NeoPixelHost::freeInstructions(pio0), PIO_INSTRUCTION_COUNT - ws2812byte_program.length);
+  CHECK_EQ(NeoPixelHost::freeInstructions(pio1), PIO_INSTRUCTION_COUNT - ws2812byte_program.length);
+
+  NeoPixelPioClaim &extra = claims[2 * NUM_PIO_STATE_MACHINES];
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, extra) == NeoPixelPioStatus::NoStateMachine);
+  CHECK_EQ(extra.sm, -1);
+
+  for (NeoPixelPioClaim &c : claims) NeoPixelPioRegistry::release(&ws2812byte_program, c);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), 0);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio1, &ws2812byte_program), 0);
+}
+
+TEST(registry_reports_no_program_space) {
+  uint offset0 = pio_add_program(pio0, &filler);
+  uint offset1 = pio_add_program(pio1, &filler);
+  NeoPixelPioClaim claim;
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, claim) == NeoPixelPioStatus::NoProgramSpace);
+  CHECK_EQ(claim.sm, -1);
+  // the state machines it looked at are free again
+  CHECK_EQ(NeoPixelHost::freeStateMachines(pio0), NUM_PIO_STATE_MACHINES);
+  CHECK_EQ(NeoPixelHost::freeStateMachines(pio1), NUM_PIO_STATE_MACHINES);
+
+  // room on pio1 only
+  pio_remove_program(pio1, &filler, offset1);
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, claim) == NeoPixelPioStatus::Ok);
+  CHECK(claim.pio == pio1);
+  NeoPixelPioRegistry::release(&ws2812byte_program, claim);
+  pio_remove_program(pio0, &filler, offset0);
+}
+
+TEST(registry_reports_no_program_space_when_slots_are_full) {
+  // NEOPIXEL_PIO_PROGRAMS other programs on each pio: the first two fill
+  // pio0's slots, so the next two go to pio1
+  const pio_program_t *others[4] = {&other1, &other2, &other3, &other4};
+  NeoPixelPioClaim claims[4], claim;
+  for (int i = 0 ; i < 4 ; i++) {
+    CHECK(NeoPixelPioRegistry::claim(others[i], claims[i]) == NeoPixelPioStatus::Ok);
+    CHECK(claims[i].pio == (i < 2 ? pio0 : pio1));
+  }
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, claim) == NeoPixelPioStatus::NoProgramSpace);
+  CHECK_EQ(claim.sm, -1);
+  NeoPixelPioRegistry::release(&ws2812byte_program, claim);
+  for (int i = 0 ; i < 4 ; i++) NeoPixelPioRegistry::release(others[i], claims[i]);
+}
+
+TEST(registry_shares_and_unloads_programs) {
+  NeoPixelPioClaim a, b;
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, a) == NeoPixelPioStatus::Ok);
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, b) == NeoPixelPioStatus::Ok);
+  CHECK(a.pio == b.pio);
+  CHECK(a.sm != b.sm);
+  CHECK_EQ(a.offset, b.offset);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), 2);
+  CHECK_EQ(NeoPixelHost::freeInstructions(pio0), PIO_INSTRUCTION_COUNT - ws2812byte_program.length);
+
+  // still loaded for b
+  NeoPixelPioRegistry::release(&ws2812byte_program, a);
+  CHECK_EQ(a.sm, -1);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), 1);
+  CHECK_EQ(NeoPixelHost::freeInstructions(pio0), PIO_INSTRUCTION_COUNT - ws2812byte_program.length);
+
+  // the last user unloads it
+  NeoPixelPioRegistry::release(&ws2812byte_program, b);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), 0);
+  CHECK_EQ(NeoPixelHost::freeInstructions(pio0), PIO_INSTRUCTION_COUNT);
+}
+
+TEST(registry_release_is_idempotent) {
+  NeoPixelPioClaim a, b;
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, a) == NeoPixelPioStatus::Ok);
+  CHECK(NeoPixelPioRegistry::claim(&ws2812byte_program, b) == NeoPixelPioStatus::Ok);
+  NeoPixelPioRegistry::release(&ws2812byte_program, a);
+  NeoPixelPioRegistry::release(&ws2812byte_program, a);
+  // b keeps its state machine and the program
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), 1);
+  CHECK_EQ(NeoPixelHost::freeStateMachines(pio0), NUM_PIO_STATE_MACHINES - 1);
+  NeoPixelPioRegistry::release(&ws2812byte_program, b);
+  NeoPixelPioRegistry::release(&ws2812byte_program, b);
+  CHECK_EQ(NeoPixelPioRegistry::users(pio0, &ws2812byte_program), 0);
+
+  // a claim that failed has nothing to release
+  NeoPixelPioClaim none;
+  none.sm = -1;
+  NeoPixelPioRegistry::release(&ws2812byte_program, none);
+}
+
+TEST(registry_status_names) {
+  CHECK(strcmp(NeoPixelPioRegistry::statusName(NeoPixelPioStatus::Ok), "ok") == 0);
+  CHECK(strcmp(NeoPixelPioRegistry::statusName(NeoPixelPioStatus::NoStateMachine),
+               "no free state machine") == 0);
+  CHECK(strcmp(NeoPixelPioRegistry::statusName(NeoPixelPioStatus::NoProgramSpace),
+               "no room for the program") == 0);
+}
+
+TEST(registry_strips_report_why_they_cannot_transmit) {
+  std::unique_ptr<Adafruit_NeoPixel> strips[2 * NUM_PIO_STATE_MACHINES];
+  for (int i = 0 ; i < 2 * NUM_PIO_STATE_MACHINES ; i++) {
+    strips[i].reset(new Adafruit_NeoPixel(4, 2 + i, NEO_GRB + NEO_KHZ800));
+    // nothing is claimed before the first show
+    CHECK(strips[i]->getPioStatus() == NeoPixelPioStatus::Unclaimed);
+    strips[i]->show();
+    CHECK(strips[i]->getPioStatus() == NeoPixelPioStatus::Ok);
+  }
+  {
+    Adafruit_NeoPixel extra(4, 20, NEO_GRB + NEO_KHZ800);
+    extra.show();
+    CHECK(extra.getPioStatus() == NeoPixelPioStatus::NoStateMachine);
+  }
+  // freeing a strip frees its state machine for the next one
+  strips[3].reset();
+  {
+    Adafruit_NeoPixel extra(4, 20, NEO_GRB + NEO_KHZ800);
+    extra.show();
+    CHECK(extra.getPioStatus() == NeoPixelPioStatus::Ok);
+  }
+  for (std::unique_ptr<Adafruit_NeoPixel> &strip : strips) strip.reset();
+  NeoPixelHost::settle();
+
+  uint offset0 = pio_add_program(pio0, &filler);
+  uint offset1 = pio_add_program(pio1, &filler);
+  {
+    Adafruit_NeoPixel strip(4, 20, NEO_GRB + NEO_KHZ800);
+    strip.show();
+    CHECK(strip.getPioStatus() == NeoPixelPioStatus::NoProgramSpace);
+  }
+  pio_remove_program(pio0, &filler, offset0);
+  pio_remove_program(pio1, &filler, offset1);
+}
@@ -0,0 +1,109 @@
+/*!
+ * @file test_scheduler.cpp
+ *
+ * The frame-tick engine on the fake clock: frames run when due and not
+ * before, the main loop gets control between them, and starting an
+ * effect preempts the running one.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_effects.h"
+#include "pico_neopixel_animations.h"
+#include "pico/stdlib.h"
+#include <vector>
+
+// Steps frames times, period_us apart, noting when each one ran
+class TickEffect : public NeoPixelEffect {
+  public:
+    TickEffect(uint32_t frames, uint32_t period_us) :
+      frames(frames), period_us(period_us) {}
+    void begin(uint64_t now_us) override {
+      steps.clear();
+      next_due = now_us;
+    }
+    bool step(uint64_t now_us) override {
+      steps.push_back(now_us);
+      next_due = now_us + period_us;
+      return steps.size() < frames;
+    }
+    std::vector<uint64_t> steps;
+
+  private:
+    uint32_t frames, period_us;
+};
+
+TEST(scheduler_steps_frames_when_due) {
+  TickEffect effect(5, 10000);
+  NeoPixelScheduler scheduler;
+  uint64_t t = time_us_64();
+  scheduler.start(&effect, t);
+  uint32_t polls = 0;
+  while (scheduler.poll(time_us_64())) {
+    polls++;
+    scheduler.idle();
+  }
+  CHECK(!scheduler.running());
+  CHECK_EQ(effect.steps.size(), 5);
+  for (size_t i = 0 ; i < effect.steps.size() ; i++) {
+    CHECK_EQ(effect.steps[i], t + i * 10000);
+  }
+  CHECK_EQ(polls, 4);
+}
+
+TEST(scheduler_poll_before_due_does_nothing) {
+  TickEffect effect(3, 10000);
+  NeoPixelScheduler scheduler;
+  uint64_t t = time_us_64();
+  scheduler.start(&effect, t);
+  CHECK(scheduler.poll(t));
+  CHECK_EQ(effect.steps.size(), 1);
+  CHECK(scheduler.poll(t + 9999));
+  CHECK_EQ(effect.steps.size(), 1);
+  CHECK_EQ(effect.nextDue(), t + 10000);
+  CHECK(scheduler.poll(t + 10000));
+  CHECK_EQ(effect.steps.size(), 2);
+}
+
+TEST(scheduler_start_preempts_running_effect) {
+  TickEffect a(10, 1000), b(2, 1000);
+  NeoPixelScheduler scheduler;
+  uint64_t t = time_us_64();
+  scheduler.start(&a, t);
+  scheduler.poll(t);
+  scheduler.poll(t + 1000);
+  scheduler.start(&b, t + 1500);
+  CHECK(scheduler.poll(t + 1500));
+  CHECK(!scheduler.poll(t + 2500));
+  CHECK(!scheduler.running());
+  CHECK_EQ(a.steps.size(), 2);
+  CHECK_EQ(b.steps.size(), 2);
+  scheduler.start(&a, t + 3000);
+  scheduler.stop();
+  CHECK(!scheduler.poll(t + 3000));
+  CHECK_EQ(a.steps.size(), 0);
+}
+
+TEST(scheduler_runs_color_wipe_on_the_strip) {
+  uint8_t saved = NeoPixelStrip::brightness;
+  NeoPixelStrip::brightness = 255;
+  NeoPixelStrip npStrip(6, 30);
+  NeoPixelHost::clearPins();
+  ColorWipeEffect wipe(npStrip, npStrip.packColor(0, 255, 0), 5);
+  NeoPixelScheduler scheduler;
+  uint64_t t = time_us_64();
+  scheduler.start(&wipe, t);
+  while (scheduler.poll(time_us_64())) scheduler.idle();
+  NeoPixelHost::settle();
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(30);
+  // one frame per pixel, each one pixel longer, every 5 ms; the first
+  // waits for the frame the strip showed when it was set up to latch
+  CHECK_EQ(pin.frames.size(), 6);
+  for (size_t i = 0 ; i < pin.frames.size() ; i++) {
+    CHECK_EQ(pin.frames[i].bytes.size(), (i + 1) * 3);
+    if (i) CHECK_EQ(pin.frames[i].startNs, (t + i * 5000) * 1000);
+  }
+  CHECK_EQ(pin.leds.size(), 18);
+  for (int i = 0 ; i < 6 ; i++) CHECK(pin.leds[i * 3] != 0);
+  NeoPixelStrip::brightness = saved;
+}
@@ -0,0 +1,67 @@
+/*!
+ * @file test_state.cpp
+ *
+ * The state colors: markStateDirty() and syncDirtyStateColors() re-read
+ * only the pixels marked, and leave the state matching the pixel buffer.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_animations.h"
+
+// The five state colors, in visual order: the four ports, then power
+static void stateColors(NeoPixelStrip &np, uint32_t colors[5]) {
+  NeoPixelStrip::State_Settings_Struct &s = np.accessState();
+  colors[0] = *s.port_rgb_1;
+  colors[1] = *s.port_rgb_2;
+  colors[2] = *s.port_rgb_3;
+  colors[3] = *s.port_rgb_4;
+  colors[4] = *s.power_rgb;
+}
+
+static void checkMatchesBuffer(NeoPixelStrip &np) {
+  NeoPixelStrip::FrameView f = np.frame();
+  uint32_t colors[5];
+  stateColors(np, colors);
+  for (uint16_t v = 0 ; v < 5 ; v++) CHECK_EQ(colors[v], f.get(v));
+}
+
+TEST(state_sync_rereads_only_the_marked_pixel) {
+  NeoPixelStrip np(8, 30, "3 1 4 0 2 ");
+  NeoPixelStrip::FrameView f = np.frame();
+  f.fill_range(0, 8, 0x010203);
+  np.updateStateColors();
+  checkMatchesBuffer(np);
+
+  // two pixels change, only one is marked
+  f.set(2, 0x405060);
+  f.set(3, 0x708090);
+  np.markStateDirty(2);
+  np.syncDirtyStateColors();
+  uint32_t colors[5];
+  stateColors(np, colors);
+  for (uint16_t v = 0 ; v < 5 ; v++) {
+    CHECK_EQ(colors[v], v == 2 ? 0x405060 : 0x010203);
+  }
+
+  // marking the other brings the whole state up to date
+  np.markStateDirty(3);
+  np.syncDirtyStateColors();
+  checkMatchesBuffer(np);
+  NeoPixelHost::settle();
+}
+
+TEST(state_follows_a_single_pixel_transition) {
+  NeoPixelStrip np(8, 31, "3 1 4 0 2 ");
+  NeoPixelStrip::FrameView f = np.frame();
+  f.fill_range(0, 8, 0);
+  np.updateStateColors();
+  // visual position 4 is electrical pixel 2
+  np.htmlSinglePixel(4, 0x0A0B0C, 0);
+  CHECK_EQ(f.get(4), 0x0A0B0C);
+  uint32_t colors[5];
+  stateColors(np, colors);
+  for (uint16_t v = 0 ; v < 5 ; v++) CHECK_EQ(colors[v], v == 4 ? 0x0A0B0C : 0);
+  checkMatchesBuffer(np);
+  NeoPixelHost::settle();
+}
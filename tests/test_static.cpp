@@ -0,0 +1,82 @@
+/*!
+ * @file test_static.cpp
+ *
+ * Strips on static buffers.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "Adafruit_NeoPixel.hpp"
+#include "FixedNeoPixel.hpp"
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+template <uint8_t BytesPerPixel>
+struct Guarded {
+  NeoPixelStaticBuffers<8, BytesPerPixel> buffers;
+  uint8_t guard[64];
+};
+
+TEST(static_rgbw_strip_on_rgb_buffers_has_no_pixels) {
+  static Guarded<3> g;
+  memset(g.guard, 0xA5, sizeof(g.guard));
+  {
+    Adafruit_NeoPixel strip(2, NEO_RGBW + NEO_KHZ800, g.buffers);
+    CHECK_EQ(strip.numPixels(), 0);
+    strip.fill(0xFFFFFFFF);
+    strip.show();
+  }
+  for (uint8_t b : g.guard) CHECK_EQ(b, 0xA5);
+}
+
+TEST(static_rgbw_strip_on_rgbw_buffers) {
+  static Guarded<4> g;
+  memset(g.guard, 0xA5, sizeof(g.guard));
+  {
+    Adafruit_NeoPixel strip(2, NEO_RGBW + NEO_KHZ800, g.buffers);
+    CHECK_EQ(strip.numPixels(), 8);
+    strip.fill(0x01020304);
+    strip.show();
+    NeoPixelHost::settle();
+    const NeoPixelHostPin &pin = NeoPixelHost::pin(2);
+    CHECK_EQ(pin.leds.size(), 32);
+    CHECK_EQ(pin.leds[28], 2); // R, G, B, W
+    CHECK_EQ(pin.leds[31], 1);
+  }
+  for (uint8_t b : g.guard) CHECK_EQ(b, 0xA5);
+}
+
+TEST(static_strip_checks_raw_buffer_size) {
+  static uint8_t pixels[8 * 3];
+  static uint32_t fifo[8];
+  Adafruit_NeoPixel rgbw(8, 2, NEO_GRBW + NEO_KHZ800, pixels, sizeof(pixels), fifo);
+  CHECK_EQ(rgbw.numPixels(), 0);
+  Adafruit_NeoPixel rgb(8, 3, NEO_GRB + NEO_KHZ800, pixels, sizeof(pixels), fifo);
+  CHECK_EQ(rgb.numPixels(), 8);
+}
+
+// the strip points into the object's own buffers
+typedef FixedNeoPixel<NEO_GRB + NEO_KHZ800, 4> Fixed4;
+static_assert(!std::is_copy_constructible<Fixed4>::value, "FixedNeoPixel copies");
+static_assert(!std::is_move_constructible<Fixed4>::value, "FixedNeoPixel moves");
+static_assert(!std::is_copy_assignable<Fixed4>::value, "FixedNeoPixel copy-assigns");
+static_assert(!std::is_move_assignable<Fixed4>::value, "FixedNeoPixel move-assigns");
+
+TEST(fixed_strip_sends_its_own_buffer) {
+  {
+    Fixed4 strip(4);
+    strip.setPixelColor(1, 0x102030);
+    strip.show();
+    NeoPixelHost::settle();
+  }
+  // the frame shown, before the blank one from the destructor
+  const NeoPixelHostPin &pin = NeoPixelHost::pin(4);
+  CHECK_EQ(pin.frames.size(), 2);
+  if (pin.frames.empty()) return;
+  const std::vector<uint8_t> &leds = pin.frames[0].bytes;
+  CHECK_EQ(leds.size(), 12);
+  CHECK_EQ(leds[3], 0x20); // G, R, B
+  CHECK_EQ(leds[4], 0x10);
+  CHECK_EQ(leds[5], 0x30);
+}
@@ -0,0 +1,35 @@
+/*!
+ * @file test_stats.cpp
+ *
+ * Frame-timing histograms, recorded to from two threads at once. The
+ * tests are built with NEOPIXEL_STATS.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "NeoPixelStats.hpp"
+#include <thread>
+
+static void recordSamples(uint32_t n) {
+  for (uint32_t i = 0 ; i < n ; i++) NeoPixelStats::record(NEOPIXEL_STAT_RENDER, i & 1023);
+}
+
+TEST(stats_from_both_cores) {
+  NeoPixelStats::reset();
+  std::thread other(recordSamples, 50000);
+  recordSamples(50000);
+  other.join();
+
+  NeoPixelHistogram h;
+  NeoPixelStats::get(NEOPIXEL_STAT_RENDER, h);
+  CHECK_EQ(h.count, 100000);
+  uint64_t sum = 0;
+  for (uint32_t i = 0 ; i < 50000 ; i++) sum += i & 1023;
+  CHECK_EQ(NeoPixelStats::total(NEOPIXEL_STAT_RENDER), 2 * sum);
+  CHECK_EQ(h.min, 0);
+  CHECK_EQ(h.max, 1023);
+  uint32_t inBuckets = 0;
+  for (int b = 0 ; b < NEOPIXEL_STATS_BUCKETS ; b++) inBuckets += h.buckets[b];
+  CHECK_EQ(inBuckets, h.count);
+  NeoPixelStats::reset();
+}
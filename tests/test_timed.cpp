@@ -0,0 +1,110 @@
+/*!
+ * @file test_timed.cpp
+ *
+ * Duration based transitions on the fake clock: the last frame lands on
+ * the end time and shows the finish color, whatever the easing, and slow
+ * frames don't stretch the transition.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_animations.h"
+#include "pico_neopixel_effects.h"
+
+// Bytes a GRB pixel of color sends at the current brightness
+static void expect_pixel(const uint8_t *p, uint32_t color) {
+  CHECK_EQ(p[0], NeoPixelStrip::adjustBrightness(color >> 8));
+  CHECK_EQ(p[1], NeoPixelStrip::adjustBrightness(color >> 16));
+  CHECK_EQ(p[2], NeoPixelStrip::adjustBrightness(color));
+}
+
+TEST(transition_all_ends_on_time_for_every_easing) {
+  const NeoPixelEasing easings[] = {
+    NeoPixelEasing::Linear, NeoPixelEasing::EaseIn, NeoPixelEasing::EaseOut,
+    NeoPixelEasing::EaseInOut, NeoPixelEasing::Cubic
+  };
+  uint8_t saved = NeoPixelStrip::brightness;
+  NeoPixelStrip::brightness = 255;
+  {
+    NeoPixelStrip np(8, 18);
+    uint32_t finish = 0x204060;
+    for (NeoPixelEasing easing : easings) {
+      NeoPixelHost::advance(1000);
+      NeoPixelHost::settle();
+      NeoPixelHost::clearPins();
+      uint64_t t0 = NeoPixelHost::now();
+      np.transitionAll(finish, 200, easing, 20);
+      NeoPixelHost::settle();
+      const NeoPixelHostPin &pin = NeoPixelHost::pin(18);
+      // a frame every 20 ms, the last one at 200 ms
+      CHECK_EQ(pin.frames.size(), 11);
+      if (pin.frames.size() != 11) continue;
+      for (size_t i = 0 ; i < pin.frames.size() ; i++) {
+        uint64_t due = t0 + i * 20000000ULL;
+        CHECK(pin.frames[i].startNs >= due);
+        CHECK(pin.frames[i].startNs < due + 50000);
+      }
+      for (int i = 0 ; i < 8 ; i++) expect_pixel(&pin.frames[10].bytes[i * 3], finish);
+      finish ^= 0x7F7F7F;
+    }
+  }
+  NeoPixelStrip::brightness = saved;
+}
+
+TEST(transition_single_ends_on_time) {
+  uint8_t saved = NeoPixelStrip::brightness;
+  NeoPixelStrip::brightness = 255;
+  {
+    NeoPixelStrip np(8, 19, "7 6 5 4 3 2 1 0 ");
+    NeoPixelHost::advance(1000);
+    NeoPixelHost::settle();
+    NeoPixelHost::clearPins();
+    uint64_t t0 = NeoPixelHost::now();
+    // 70 ms is not a whole number of frames; the last one is cut short
+    np.transitionSingle(2, 0x0A0B0C, 70, NeoPixelEasing::EaseInOut, 20);
+    NeoPixelHost::settle();
+    const NeoPixelHostPin &pin = NeoPixelHost::pin(19);
+    CHECK_EQ(pin.frames.size(), 5);
+    if (pin.frames.size() == 5) {
+      CHECK(pin.frames[3].startNs < t0 + 60050000ULL);
+      CHECK(pin.frames[4].startNs >= t0 + 70000000ULL);
+      CHECK(pin.frames[4].startNs < t0 + 70050000ULL);
+      // showChanged() sends up to the pixel, electrical index 5
+      CHECK_EQ(pin.frames[4].bytes.size(), 18);
+      if (pin.frames[4].bytes.size() == 18) {
+        expect_pixel(&pin.frames[4].bytes[15], 0x0A0B0C);
+      }
+    }
+  }
+  NeoPixelStrip::brightness = saved;
+}
+
+TEST(transition_all_is_not_stretched_by_slow_frames) {
+  uint8_t saved = NeoPixelStrip::brightness;
+  NeoPixelStrip::brightness = 255;
+  {
+    // a frame takes 15 ms on the wire, three times the frame period
+    NeoPixelStrip np(500, 20);
+    NeoPixelHost::advance(20000);
+    NeoPixelHost::settle();
+    NeoPixelHost::clearPins();
+    uint64_t t0 = NeoPixelHost::now();
+    np.transitionAll(0x112233, 100, NeoPixelEasing::Linear, 5);
+    NeoPixelHost::settle();
+    const NeoPixelHostPin &pin = NeoPixelHost::pin(20);
+    CHECK(pin.frames.size() >= 2);
+    CHECK(pin.frames.size() < 100 / 5);
+    if (pin.frames.size() >= 2) {
+      const NeoPixelHostFrame &last = pin.frames.back();
+      // at most one frame time past the end
+      CHECK(pin.frames[pin.frames.size() - 2].startNs < t0 + 100000000ULL);
+      CHECK(last.startNs < t0 + 100000000ULL + 16000000ULL);
+      CHECK_EQ(last.bytes.size(), 1500);
+      if (last.bytes.size() == 1500) {
+        expect_pixel(&last.bytes[0], 0x112233);
+        expect_pixel(&last.bytes[1497], 0x112233);
+      }
+    }
+  }
+  NeoPixelStrip::brightness = saved;
+}
@@ -0,0 +1,169 @@
+/*!
+ * @file test_timeline.cpp
+ *
+ * Keyframe actions on sub-ranges of a strip, played on the fake clock:
+ * Fill, FillHSV and Rainbow set their range at once, count 0 reaches the
+ * end of the strip, a Fade replaces one running on the same range, and
+ * Brightness ignores the range.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_animations.h"
+#include "pico_neopixel_timeline.h"
+#include "pico/stdlib.h"
+
+static const NeoPixelEasing linear = NeoPixelEasing::Linear;
+
+// Moves the clock to ms after origin and plays the frame due then
+static bool stepAt(NeoPixelTimelinePlayer &player, uint64_t origin, uint32_t ms) {
+  uint64_t t = origin + ms * 1000ULL;
+  if (t > time_us_64()) NeoPixelHost::advance(t - time_us_64());
+  return player.step(time_us_64());
+}
+
+static uint32_t hsv(uint16_t hue, uint8_t sat, uint8_t val) {
+  return Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV(hue, sat, val));
+}
+
+static constexpr NeoPixelKeyframe fill_keys[] = {
+  {0, 0, 0, NeoPixelKeyAction::Fill, linear, 0x000000, 0},
+  {0, 2, 3, NeoPixelKeyAction::Fill, linear, 0x102030, 0},
+  {10000, 6, 0, NeoPixelKeyAction::FillHSV, linear, keyHSV(21845, 200, 180), 0},
+};
+
+TEST(timeline_fills_set_their_range) {
+  NeoPixelStrip np(10, 12);
+  NeoPixelTimelinePlayer player(np, makeTimeline(fill_keys));
+  NeoPixelScheduler().run(&player);
+  NeoPixelStrip::FrameView f = np.frame();
+  for (uint16_t v = 0 ; v < 10 ; v++) {
+    uint32_t want = 0;
+    if (v >= 2 && v < 5) want = 0x102030;
+    // count 0 runs to the end of the strip
+    if (v >= 6) want = hsv(21845, 200, 180);
+    CHECK_EQ(f.get(v), want);
+  }
+  NeoPixelHost::settle();
+}
+
+static constexpr NeoPixelKeyframe rainbow_keys[] = {
+  {0, 0, 0, NeoPixelKeyAction::Fill, linear, 0x010101, 0},
+  {0, 3, 5, NeoPixelKeyAction::Rainbow, linear, keyHSV(1000, 255, 200), 0},
+  // past the end of the strip: clipped
+  {0, 9, 4, NeoPixelKeyAction::Rainbow, linear, keyHSV(0, 255, 255), 0},
+};
+
+TEST(timeline_rainbow_runs_round_the_wheel_along_its_range) {
+  NeoPixelStrip np(10, 13);
+  NeoPixelTimelinePlayer player(np, makeTimeline(rainbow_keys));
+  NeoPixelScheduler().run(&player);
+  NeoPixelStrip::FrameView f = np.frame();
+  for (uint16_t v = 0 ; v < 3 ; v++) CHECK_EQ(f.get(v), 0x010101);
+  for (uint16_t v = 3 ; v < 8 ; v++) {
+    CHECK_EQ(f.get(v), hsv(1000 + (v - 3) * 65536L / 5, 255, 200));
+  }
+  CHECK_EQ(f.get(8), 0x010101);
+  CHECK_EQ(f.get(9), hsv(0, 255, 255));
+  NeoPixelHost::settle();
+}
+
+static constexpr NeoPixelKeyframe fade_keys[] = {
+  {0, 0, 0, NeoPixelKeyAction::Fill, linear, 0x000000, 0},
+  {0, 4, 2, NeoPixelKeyAction::Fade, linear, 0xC80000, 100},
+  {0, 7, 0, NeoPixelKeyAction::Fade, linear, 0x0000C8, 100},
+};
+
+TEST(timeline_fade_moves_its_range_only) {
+  NeoPixelStrip np(10, 14);
+  NeoPixelTimelinePlayer player(np, makeTimeline(fade_keys));
+  NeoPixelStrip::FrameView f = np.frame();
+  uint64_t origin = time_us_64();
+  player.begin(origin);
+  CHECK(stepAt(player, origin, 0));
+  CHECK(stepAt(player, origin, 50));
+  uint32_t red = f.get(4) >> 16;
+  CHECK(red > 0x50 && red < 0x78);
+  CHECK_EQ(f.get(5), f.get(4));
+  uint32_t blue = f.get(7);
+  CHECK(blue > 0x50 && blue < 0x78);
+  CHECK_EQ(f.get(9), blue);
+  CHECK_EQ(f.get(3), 0);
+  CHECK_EQ(f.get(6), 0);
+
+  CHECK(!stepAt(player, origin, 100));
+  for (uint16_t v = 0 ; v < 10 ; v++) {
+    uint32_t want = 0;
+    if (v == 4 || v == 5) want = 0xC80000;
+    if (v >= 7) want = 0x0000C8;
+    CHECK_EQ(f.get(v), want);
+  }
+  NeoPixelHost::settle();
+}
+
+static constexpr NeoPixelKeyframe refade_keys[] = {
+  {0, 0, 0, NeoPixelKeyAction::Fill, linear, 0x000000, 0},
+  {0, 4, 2, NeoPixelKeyAction::Fade, linear, 0xC80000, 200},
+  // the same range turns round before the first fade is done
+  {50000, 4, 2, NeoPixelKeyAction::Fade, linear, 0x0000C8, 100},
+};
+
+TEST(timeline_fade_replaces_the_running_fade) {
+  NeoPixelStrip np(10, 15);
+  NeoPixelTimelinePlayer player(np, makeTimeline(refade_keys));
+  NeoPixelStrip::FrameView f = np.frame();
+  uint64_t origin = time_us_64();
+  player.begin(origin);
+  CHECK(stepAt(player, origin, 0));
+  CHECK(stepAt(player, origin, 40));
+  uint32_t mid = f.get(4);
+  CHECK((mid >> 16) > 0x20 && (mid >> 16) < 0x30);
+  // the second fade starts from the color the first had reached
+  CHECK(stepAt(player, origin, 50));
+  CHECK_EQ(f.get(4), mid);
+  CHECK(stepAt(player, origin, 100));
+  CHECK((f.get(4) >> 16) < (mid >> 16));
+  CHECK((f.get(4) & 0xFF) > 0);
+  // done at 150 ms; the first fade, due to end at 200 ms, is gone
+  CHECK(!stepAt(player, origin, 150));
+  CHECK_EQ(f.get(4), 0x0000C8);
+  CHECK_EQ(f.get(5), 0x0000C8);
+  NeoPixelHost::settle();
+}
+
+static constexpr NeoPixelKeyframe brightness_keys[] = {
+  {0, 0, 0, NeoPixelKeyAction::Fill, linear, 0x808080, 0},
+  {0, 0, 0, NeoPixelKeyAction::Brightness, linear, 20, 0},
+  // a range, which brightness doesn't have
+  {0, 3, 2, NeoPixelKeyAction::Brightness, linear, 220, 100},
+  {150000, 0, 0, NeoPixelKeyAction::Brightness, linear, 200, 100},
+  // at once, dropping the fade above
+  {200000, 0, 0, NeoPixelKeyAction::Brightness, linear, 40, 0},
+};
+
+TEST(timeline_brightness_fades_the_whole_strip) {
+  uint8_t saved = NeoPixelStrip::brightness;
+  {
+    NeoPixelStrip np(10, 16);
+    NeoPixelTimelinePlayer player(np, makeTimeline(brightness_keys));
+    uint64_t origin = time_us_64();
+    player.begin(origin);
+    CHECK(stepAt(player, origin, 0));
+    CHECK(stepAt(player, origin, 50));
+    CHECK(NeoPixelStrip::brightness > 100);
+    CHECK(NeoPixelStrip::brightness < 140);
+    CHECK(stepAt(player, origin, 100));
+    CHECK_EQ(NeoPixelStrip::brightness, 220);
+    CHECK(stepAt(player, origin, 150));
+    CHECK(stepAt(player, origin, 180));
+    CHECK(NeoPixelStrip::brightness < 220);
+    CHECK(!stepAt(player, origin, 200));
+    CHECK_EQ(NeoPixelStrip::brightness, 40);
+    // every pixel is sent at the new brightness
+    NeoPixelHost::settle();
+    const NeoPixelHostPin &pin = NeoPixelHost::pin(16);
+    CHECK_EQ(pin.leds.size(), 30);
+    for (uint8_t b : pin.leds) CHECK_EQ(b, NeoPixelStrip::adjustBrightness(0x80));
+  }
+  NeoPixelStrip::brightness = saved;
+}
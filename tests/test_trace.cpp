@@ -0,0 +1,39 @@
+/*!
+ * @file test_trace.cpp
+ *
+ * The trace ring, logged to from two threads at once.
+ *
+ */
+
+#include "NeoPixelTest.hpp"
+#include "pico_neopixel_trace.h"
+#include <thread>
+
+static void logRecords(uint16_t event, uint32_t n) {
+  for (uint32_t i = 0 ; i < n ; i++) neopixel_trace(event, i, i);
+}
+
+TEST(trace_from_both_cores) {
+  static NeoPixelTraceRecord out[NEOPIXEL_TRACE_LENGTH];
+
+  // fewer than fit: none may be lost
+  std::thread other(logRecords, TRACE_PIXEL_COLOR, 100);
+  logRecords(TRACE_SINGLE_PIXEL, 100);
+  other.join();
+  CHECK_EQ(neopixel_trace_read(out, NEOPIXEL_TRACE_LENGTH), 200);
+
+  // many more: every record kept must be whole, and in order per thread
+  std::thread more(logRecords, TRACE_PIXEL_COLOR, 50000);
+  logRecords(TRACE_SINGLE_PIXEL, 50000);
+  more.join();
+  uint16_t n = neopixel_trace_read(out, NEOPIXEL_TRACE_LENGTH);
+  CHECK_EQ(n, NEOPIXEL_TRACE_LENGTH);
+  int64_t last[2] = {-1, -1};
+  for (uint16_t i = 0 ; i < n ; i++) {
+    CHECK_EQ(out[i].a, out[i].b);
+    CHECK(out[i].event == TRACE_PIXEL_COLOR || out[i].event == TRACE_SINGLE_PIXEL);
+    int t = out[i].event == TRACE_PIXEL_COLOR;
+    CHECK((int64_t)out[i].a > last[t]);
+    last[t] = out[i].a;
+  }
+}
@@ -0,0 +1,41 @@
+// Generated by tools/timeline2c.py from timelines/gamecube_startup.txt, do not edit
+#pragma once
+#include "pico_neopixel_timeline.h"
+
+constexpr NeoPixelKeyframe gamecube_startup_keys[] = {
+    // time_us, first, count, action, easing, value, duration_ms
+    {0, 0, 0, NeoPixelKeyAction::Fill, NeoPixelEasing::Linear, 0x546BDE, 0},
+    {0, 0, 0, NeoPixelKeyAction::Brightness, NeoPixelEasing::Linear, 1, 0},
+    {0, 0, 0, NeoPixelKeyAction::Brightness, NeoPixelEasing::Linear, 160, 900},
+    {1158620, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(0, 255, 210), 0},
+    {1287931, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(2731, 255, 160), 0},
+    {1417241, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(5462, 255, 160), 0},
+    {1546551, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(8193, 255, 160), 0},
+    {1675862, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(10924, 255, 160), 0},
+    {1805172, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(13655, 255, 160), 0},
+    {1934482, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(16386, 255, 210), 0},
+    {2063793, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(19117, 255, 160), 0},
+    {2193103, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(21848, 255, 160), 0},
+    {2322413, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(24579, 255, 160), 0},
+    {2451724, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(27310, 255, 160), 0},
+    {2581034, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(30041, 255, 160), 0},
+    {2710344, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(32772, 255, 160), 0},
+    {2839655, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(35503, 255, 160), 0},
+    {2968965, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(38234, 255, 210), 0},
+    {3098275, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(40965, 255, 160), 0},
+    {3227586, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(43696, 255, 160), 0},
+    {3356896, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(46427, 255, 160), 0},
+    {3486206, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(49158, 255, 210), 0},
+    {3615517, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(51889, 255, 160), 0},
+    {3744827, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(54620, 255, 160), 0},
+    {3874137, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(57351, 255, 160), 0},
+    {4003448, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(60082, 255, 160), 0},
+    {4132758, 0, 0, NeoPixelKeyAction::Rainbow, NeoPixelEasing::Linear, keyHSV(62813, 255, 160), 0},
+    {4262068, 0, 0, NeoPixelKeyAction::Fill, NeoPixelEasing::Linear, 0x4B0082, 0},
+    {4520689, 0, 0, NeoPixelKeyAction::Fill, NeoPixelEasing::Linear, 0x000000, 0},
+    {4779310, 0, 0, NeoPixelKeyAction::Fill, NeoPixelEasing::Linear, 0xF0F0F0, 0},
+    {4779310, 0, 0, NeoPixelKeyAction::Brightness, NeoPixelEasing::Linear, 100, 1200},
+    {5979310, 0, 0, NeoPixelKeyAction::Fade, NeoPixelEasing::Linear, 0x546BDE, 600},
+};
+
+constexpr NeoPixelTimeline gamecube_startup = makeTimeline(gamecube_startup_keys);
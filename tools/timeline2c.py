@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Compiles a text timeline into a constexpr NeoPixelKeyframe array.
+
+    python3 tools/timeline2c.py timelines/gamecube_startup.txt > timelines/gamecube_startup.h
+
+Each line of the text is a directive or a keyframe; '#' starts a comment.
+
+Directives:
+    name <identifier>           names the generated timeline
+    tempo <bpm> <ticks/beat>    sets the tick used by times like 6t
+    origin <time>               tick 0 is at this time
+
+Keyframes, sorted by time:
+    <time> fill       <range> rgb <r> <g> <b>
+    <time> fill       <range> hsv <hue> <sat> <val>
+    <time> rainbow    <range> hsv <hue> <sat> <val>
+    <time> fade       <range> rgb <r> <g> <b> <duration> [easing]
+    <time> brightness <value> [<duration> [easing]]
+
+A time is a sum of terms such as 900ms, 250us or 6t, e.g. 30t+1200ms.
+A range is 'all', <first>- (to the end), <first>-<last> or a single pixel,
+in visual order. Easing is linear (default), ease_in, ease_out,
+ease_in_out or cubic.
+"""
+
+import re
+import sys
+
+EASINGS = {
+    "linear": "Linear",
+    "ease_in": "EaseIn",
+    "ease_out": "EaseOut",
+    "ease_in_out": "EaseInOut",
+    "cubic": "Cubic",
+}
+
+
+class TimelineError(Exception):
+    pass
+
+
+class Compiler:
+    def __init__(self):
+        self.name = "timeline"
+        self.tick_num = None  # tick length is tick_num / tick_den us
+        self.tick_den = 1
+        self.origin_us = 0
+        self.keys = []
+
+    def time(self, text):
+        total = 0
+        for term in text.split("+"):
+            m = re.fullmatch(r"(\d+)(ms|us|t)", term)
+            if not m:
+                raise TimelineError("bad time '%s'" % term)
+            n, unit = int(m.group(1)), m.group(2)
+            if unit == "ms":
+                total += n * 1000
+            elif unit == "us":
+                total += n
+            else:
+                if self.tick_num is None:
+                    raise TimelineError("tick time before a tempo line")
+                # same rounding as NeoPixelBeatClock::deadline()
+                total += self.origin_us + n * self.tick_num // self.tick_den
+        return total
+
+    @staticmethod
+    def duration_ms(text):
+        m = re.fullmatch(r"(\d+)(ms|s)", text)
+        if not m:
+            raise TimelineError("bad duration '%s'" % text)
+        return int(m.group(1)) * (1000 if m.group(2) == "s" else 1)
+
+    @staticmethod
+    def range(text):
+        if text == "all":
+            return 0, 0
+        m = re.fullmatch(r"(\d+)(-(\d*))?", text)
+        if not m:
+            raise TimelineError("bad range '%s'" % text)
+        first = int(m.group(1))
+        if m.group(2) is None:
+            return first, 1
+        if m.group(3) == "":
+            return first, 0
+        last = int(m.group(3))
+        if last < first:
+            raise TimelineError("range '%s' ends before it starts" % text)
+        return first, last - first + 1
+
+    @staticmethod
+    def color(args):
+        if len(args) < 4 or args[0] not in ("rgb", "hsv"):
+            raise TimelineError("expected rgb or hsv and three values")
+        a, b, c = (int(v) for v in args[1:4])
+        if args[0] == "rgb":
+            return "rgb", "0x%06X" % (a << 16 | b << 8 | c), args[4:]
+        return "hsv", "keyHSV(%d, %d, %d)" % (a, b, c), args[4:]
+
+    @staticmethod
+    def easing(args):
+        if not args:
+            return "Linear"
+        if args[0] not in EASINGS:
+            raise TimelineError("unknown easing '%s'" % args[0])
+        return EASINGS[args[0]]
+
+    def line(self, words):
+        cmd = words[0]
+        if cmd == "name":
+            self.name = words[1]
+        elif cmd == "tempo":
+            self.tick_num = 60000000
+            self.tick_den = int(words[1]) * int(words[2])
+        elif cmd == "origin":
+            self.origin_us = self.time(words[1])
+        else:
+            self.keyframe(self.time(cmd), words[1], words[2:])
+
+    def keyframe(self, t, action, args):
+        first, count, easing, duration = 0, 0, "Linear", 0
+        if action == "brightness":
+            value = str(int(args[0]))
+            if len(args) > 1:
+                duration = self.duration_ms(args[1])
+                easing = self.easing(args[2:])
+            kind = "Brightness"
+        else:
+            first, count = self.range(args[0])
+            space, value, rest = self.color(args[1:])
+            if action == "fill":
+                kind = "Fill" if space == "rgb" else "FillHSV"
+            elif action == "rainbow" and space == "hsv":
+                kind = "Rainbow"
+            elif action == "fade" and space == "rgb":
+                kind = "Fade"
+                if not rest:
+                    raise TimelineError("fade needs a duration")
+                duration = self.duration_ms(rest[0])
+                easing = self.easing(rest[1:])
+            else:
+                raise TimelineError("can't %s with %s" % (action, space))
+        if self.keys and t < self.keys[-1][0]:
+            raise TimelineError("keyframes must be in time order")
+        self.keys.append((t, first, count, kind, easing, value, duration))
+
+    def compile(self, lines, source):
+        for number, text in enumerate(lines, 1):
+            words = text.split("#", 1)[0].split()
+            if not words:
+                continue
+            try:
+                self.line(words)
+            except (TimelineError, IndexError, ValueError) as e:
+                raise SystemExit("%s:%d: %s" % (source, number, e))
+        return self.output(source)
+
+    def output(self, source):
+        out = [
+            "// Generated by tools/timeline2c.py from %s, do not edit" % source,
+            "#pragma once",
+            '#include "pico_neopixel_timeline.h"',
+            "",
+            "constexpr NeoPixelKeyframe %s_keys[] = {" % self.name,
+            "    // time_us, first, count, action, easing, value, duration_ms",
+        ]
+        for t, first, count, kind, easing, value, duration in self.keys:
+            out.append(
+                "    {%d, %d, %d, NeoPixelKeyAction::%s, NeoPixelEasing::%s, %s, %d},"
+                % (t, first, count, kind, easing, value, duration)
+            )
+        out += [
+            "};",
+            "",
+            "constexpr NeoPixelTimeline %s = makeTimeline(%s_keys);"
+            % (self.name, self.name),
+            "",
+        ]
+        return "\n".join(out)
+
+
+def main():
+    if len(sys.argv) != 2:
+        raise SystemExit("usage: timeline2c.py <timeline.txt>")
+    with open(sys.argv[1]) as f:
+        sys.stdout.write(Compiler().compile(f.readlines(), sys.argv[1]))
+
+
+if __name__ == "__main__":
+    main()